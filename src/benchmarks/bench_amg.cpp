@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "amgSolver.hpp"
+#include "meshGenerator.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+// Setup and PCG time of AmgSolver against Eigen simplicial LDL^T for growing plates
+// Usage: bench_amg [max_nx] [threads]
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+    const int maxNx = argc > 1 ? std::stoi(argv[1]) : 320;
+    setThreadsCount(argc > 2 ? std::stoi(argv[2]) : getThreadsCount());
+
+    const std::string filename = "bench_plate.k";
+    std::cout << "DOFs\tlevels\tcomplexity\tsetup, s\titerations\tsolve, s\tLDLT, s\trelative error" << std::endl;
+    for (int nx = 40; nx <= maxNx; nx *= 2)
+    {
+        writePlateMesh(filename, nx, nx * 5 / 3);
+        Solver solver(filename, 0.3, 2.e11);
+        solver.calcuateStiffnessMatrix();
+        solver.applyLoad();
+        std::remove(filename.c_str());
+
+        const auto &K = solver.getMatrix();
+
+        auto start = std::chrono::steady_clock::now();
+        AmgSolver amg(solver.getGeometry());
+        amg.compute(K);
+        const double setup = seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        Eigen::VectorX<double> result = amg.solve(solver.getLoadVector());
+        const double solution = seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        LDLTSolver ldlt;
+        ldlt.compute(K);
+        const Eigen::VectorX<double> expected = ldlt.solve(solver.getLoadVector());
+        const double direct = seconds(start);
+
+        std::cout << K.rows() << "\t" << amg.getPreconditioner().getLevelsCount() << "\t"
+                  << amg.getPreconditioner().getComplexity() << "\t" << setup << "\t"
+                  << amg.getIterations() << "\t" << solution << "\t" << direct << "\t"
+                  << (result - expected).norm() / expected.norm() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "meshGenerator.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+// Strong scaling of DomainDecompositionSolver against monolithic LDL^T
+// Usage: bench_domainDecomposition [nx] [ny] [max_threads]
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 150;
+    const int ny = argc > 2 ? std::stoi(argv[2]) : 250;
+    const int maxThreads = argc > 3 ? std::stoi(argv[3]) : 32;
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, ny);
+
+    Solver solver(filename, 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    std::remove(filename.c_str());
+
+    std::cout << "DOFs: " << solver.getMatrix().rows() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    solver.setBackend(Solver::LDLT);
+    solver.solve();
+    const double reference = seconds(start);
+    const Eigen::VectorX<double> expected = solver.getDisplacements();
+
+    std::cout << "LDLT: " << reference << " s" << std::endl;
+    std::cout << "threads\ttime, s\tspeedup\trelative error" << std::endl;
+
+    double single = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        setThreadsCount(threads);
+        solver.setBackend(Solver::DOMAIN_DECOMPOSITION);
+
+        start = std::chrono::steady_clock::now();
+        solver.solve();
+        const double time = seconds(start);
+        if (threads == 1)
+            single = time;
+
+        const double error = (solver.getDisplacements() - expected).norm() / expected.norm();
+        std::cout << threads << "\t" << time << "\t" << single / time << "\t" << error << std::endl;
+    }
+
+    return 0;
+}
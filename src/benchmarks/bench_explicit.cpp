@@ -0,0 +1,44 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "explicitSolver.hpp"
+#include "meshGenerator.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+// Explicit time steps per second against the number of threads for a plate
+// Usage: bench_explicit [nx] [steps] [max_threads]
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 400;
+    const int steps = argc > 2 ? std::stoi(argv[2]) : 200;
+    const int maxThreads = argc > 3 ? std::stoi(argv[3]) : getThreadsCount();
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, nx * 5 / 3);
+    Solver solver(filename, 0.3, 2.e11);
+    solver.applyForces();
+    std::remove(filename.c_str());
+
+    std::cout << "Elements: " << solver.getGeometry().getElements().size()
+              << ", DOFs: " << solver.getLoadVector().size() << std::endl;
+    std::cout << "threads\tcolors\tsteps/s\telements/s" << std::endl;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        setThreadsCount(threads);
+        ExplicitSolver dynamics(solver.getGeometry(), solver.getElasticityMatrix(), 7850.0);
+        dynamics.setLoad(solver.getLoadVector());
+
+        const auto start = std::chrono::steady_clock::now();
+        dynamics.run(steps * dynamics.getTimeStep());
+        const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << threads << "\t" << dynamics.getColorsCount() << "\t" << steps / time << "\t"
+                  << steps * solver.getGeometry().getElements().size() / time << std::endl;
+    }
+
+    return 0;
+}
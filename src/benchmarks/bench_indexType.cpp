@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Eigen/SparseCholesky>
+
+#include "meshGenerator.hpp"
+#include "solver.hpp"
+
+// Cost of 32-bit and 64-bit sparse indices, see FEM_INDEX_64: matrix memory, assembly from triplets,
+// products with the upper stored stiffness matrix and LDLT factorization of it
+// Usage: bench_indexType [nx] [products]
+
+static double seconds(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename StorageIndex>
+static void measure(const SparseMatrix &matrix, const Eigen::VectorX<double> &b, int products)
+{
+    typedef Eigen::SparseMatrix<double, Eigen::ColMajor, StorageIndex> Matrix;
+
+    std::vector<Eigen::Triplet<double, StorageIndex>> triplets;
+    triplets.reserve(matrix.nonZeros());
+    for (Index k = 0; k < matrix.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(matrix, k); it; ++it)
+            triplets.emplace_back(it.row(), it.col(), it.value());
+
+    auto start = std::chrono::steady_clock::now();
+    Matrix upper(matrix.rows(), matrix.cols());
+    upper.setFromTriplets(triplets.begin(), triplets.end());
+    const double assembly = seconds(start);
+    const size_t memory = upper.nonZeros() * (sizeof(double) + sizeof(StorageIndex)) + (upper.outerSize() + 1) * sizeof(StorageIndex);
+
+    Eigen::VectorX<double> y(b.size());
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < products; ++i)
+        y.noalias() = upper.template selfadjointView<Eigen::Upper>() * b;
+    const double product = seconds(start);
+
+    Eigen::SimplicialLDLT<Matrix, Eigen::Upper> ldlt;
+    start = std::chrono::steady_clock::now();
+    ldlt.compute(upper);
+    const double factorization = seconds(start);
+    if (ldlt.info() != Eigen::Success)
+        throw "Factorization failed";
+
+    start = std::chrono::steady_clock::now();
+    const Eigen::VectorX<double> x = ldlt.solve(b);
+    const double solve = seconds(start);
+
+    const Eigen::VectorX<double> residual = upper.template selfadjointView<Eigen::Upper>() * x - b;
+    std::cout << 8 * sizeof(StorageIndex) << "\t" << memory / (1024.0 * 1024.0) << "\t" << assembly << "\t"
+              << products / product << "\t" << factorization << "\t" << solve << "\t" << residual.norm() / b.norm() << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 200;
+    const int products = argc > 2 ? std::stoi(argv[2]) : 100;
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, nx * 5 / 3);
+    Solver solver(filename, 0.3, 2.e11);
+    std::remove(filename.c_str());
+
+    solver.calcuateStiffnessMatrix();
+    solver.applyForces();
+    solver.applyConstraints();
+    const SparseMatrix &matrix = solver.getMatrix();
+    std::cout << "DOFs: " << matrix.rows() << ", non-zeros: " << matrix.nonZeros() << ", build index: "
+              << 8 * sizeof(Index) << " bit" << std::endl;
+
+    std::cout << "index, bit\tmatrix, MB\tassembly, s\tproducts, 1/s\tfactorization, s\tsolve, s\trelative residual" << std::endl;
+    measure<int32_t>(matrix, solver.getLoadVector(), products);
+    measure<int64_t>(matrix, solver.getLoadVector(), products);
+
+    return 0;
+}
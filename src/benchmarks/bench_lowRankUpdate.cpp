@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "meshGenerator.hpp"
+#include "solver.hpp"
+
+// Changing a few constraints: refactorization against low-rank update of the factorization
+// Usage: bench_lowRankUpdate [nx] [backend]
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 200;
+    const Solver::Backend backend = Solver::getBackendByName(argc > 2 ? argv[2] : "supernodal");
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, nx * 5 / 3);
+    Solver solver(filename, 0.3, 2.e11);
+    std::remove(filename.c_str());
+    solver.setBackend(backend);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    auto start = std::chrono::steady_clock::now();
+    solver.factorize();
+    const double factorization = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    solver.solve();
+    const double solution = seconds(start);
+    std::cout << "DOFs: " << solver.getMatrix().rows() << ", factorization: " << factorization
+              << " s, solve: " << solution << " s" << std::endl;
+
+    // Nodes along the middle of the plate are fixed one by one, with refactorization for reference
+    std::cout << "DOFs changed\trank\tupdate, s\tsolve, s\trefactorization, s\trelative difference" << std::endl;
+    auto &boundaries = solver.getGeometry().getBoundaries();
+    const int nodesCount = solver.getGeometry().getNodes().size();
+    boundaries.push_back(Boundary());
+    for (int count = 1; count <= 8; count *= 2)
+    {
+        boundaries.back().nodes.clear();
+        for (int i = 0; i < count; ++i)
+            boundaries.back().nodes.push_back(BoundaryNode(BoundaryNode::UXY, nodesCount / 2 + i));
+
+        start = std::chrono::steady_clock::now();
+        solver.applyConstraints();
+        const double update = seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        solver.solve();
+        const double updatedSolution = seconds(start);
+        const Eigen::VectorX<double> updated = solver.getDisplacements();
+        const int rank = solver.getUpdateRank();
+
+        start = std::chrono::steady_clock::now();
+        solver.factorize();
+        solver.solve();
+        const double refactorization = seconds(start);
+
+        std::cout << 2 * count << "\t" << rank << "\t" << update << "\t" << updatedSolution << "\t" << refactorization << "\t"
+                  << (updated - solver.getDisplacements()).norm() / solver.getDisplacements().norm() << std::endl;
+
+        // The next change is relative to the original factorization again
+        boundaries.back().nodes.clear();
+        solver.applyConstraints();
+        solver.factorize();
+    }
+
+    return 0;
+}
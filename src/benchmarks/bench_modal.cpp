@@ -0,0 +1,41 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "meshGenerator.hpp"
+#include "modalSolver.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+// Time of the lowest modes by shift-invert block Lanczos for growing plates
+// Usage: bench_modal [max_nx] [modes] [block_size]
+
+int main(int argc, char * argv[])
+{
+    const int maxNx = argc > 1 ? std::stoi(argv[1]) : 160;
+    const int modesCount = argc > 2 ? std::stoi(argv[2]) : 10;
+    const int blockSize = argc > 3 ? std::stoi(argv[3]) : 4;
+
+    const std::string filename = "bench_plate.k";
+    std::cout << "DOFs\tblocks\ttime, s\tf1, Hz\tf" << modesCount << ", Hz" << std::endl;
+    for (int nx = 20; nx <= maxNx; nx *= 2)
+    {
+        writePlateMesh(filename, nx, nx * 5 / 3);
+        Solver solver(filename, 0.3, 2.e11);
+        solver.calcuateStiffnessMatrix();
+        solver.applyConstraints();
+        std::remove(filename.c_str());
+
+        const auto start = std::chrono::steady_clock::now();
+        ModalSolver modal(solver, 7850.0);
+        modal.setBlockSize(blockSize);
+        modal.solve(modesCount);
+        const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << solver.getMatrix().rows() << "\t" << modal.getIterations() << "\t" << time << "\t"
+                  << modal.getFrequencies()(0) << "\t" << modal.getFrequencies()(modesCount - 1) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "nodeGrid.hpp"
+
+// Region queries through NodeGrid against linear scans of all nodes
+// Usage: bench_nodeGrid [nodes] [queries]
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+    const int count = argc > 1 ? std::stoi(argv[1]) : 2000000;
+    const int queries = argc > 2 ? std::stoi(argv[2]) : 1000;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+    std::vector<Node> nodes;
+    nodes.reserve(count);
+    for (int i = 0; i < count; ++i)
+        nodes.push_back(Node(0.15 * coordinate(generator), 0.25 * coordinate(generator), i));
+
+    auto start = std::chrono::steady_clock::now();
+    NodeGrid grid;
+    grid.build(nodes);
+    std::cout << "Nodes: " << count << ", build: " << seconds(start) << " s" << std::endl;
+
+    // Thin boxes and segments, like edges of load regions
+    std::vector<std::vector<double>> regions;
+    for (int i = 0; i < queries; ++i)
+    {
+        const double x = 0.15 * coordinate(generator), y = 0.25 * coordinate(generator);
+        regions.push_back({x, y, x + 0.02 * coordinate(generator), y + 0.02 * coordinate(generator)});
+    }
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto &r: regions)
+        found += grid.findInBox(r[0], r[2], r[1], r[3]).size() + grid.findNearSegment(r[0], r[1], r[2], r[3], 1.e-4).size();
+    const double indexed = seconds(start);
+
+    size_t scanned = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto &r: regions)
+    {
+        const double dx = r[2] - r[0], dy = r[3] - r[1], length2 = dx * dx + dy * dy;
+        for (auto &node: nodes)
+        {
+            if (node.x >= r[0] && node.x <= r[2] && node.y >= r[1] && node.y <= r[3])
+                ++scanned;
+            double t = ((node.x - r[0]) * dx + (node.y - r[1]) * dy) / length2;
+            t = std::max(0.0, std::min(1.0, t));
+            const double ex = node.x - r[0] - t * dx, ey = node.y - r[1] - t * dy;
+            if (ex * ex + ey * ey <= 1.e-8)
+                ++scanned;
+        }
+    }
+    const double linear = seconds(start);
+
+    std::cout << "Queries: " << 2 * queries << ", found: " << found << " (" << scanned << " by scan)" << std::endl;
+    std::cout << "NodeGrid: " << indexed << " s, linear scan: " << linear << " s" << std::endl;
+
+    return 0;
+}
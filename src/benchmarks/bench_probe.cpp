@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "meshGenerator.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+// Batched point probes through the triangle BVH
+// Usage: bench_probe [nx] [ny] [points] [max_threads]
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 300;
+    const int ny = argc > 2 ? std::stoi(argv[2]) : 500;
+    const int count = argc > 3 ? std::stoi(argv[3]) : 4000000;
+    const int maxThreads = argc > 4 ? std::stoi(argv[4]) : 32;
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, ny);
+
+    Solver solver(filename, 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    solver.setBackend(Solver::SUPERNODAL);
+    solver.solve();
+    std::remove(filename.c_str());
+    std::cout << "Elements: " << solver.getGeometry().getElements().size() << std::endl;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> x(0.0, 0.15), y(0.0, 0.25);
+    std::vector<Eigen::Vector2d> points(count);
+    for (auto &point: points)
+        point = Eigen::Vector2d(x(generator), y(generator));
+
+    auto start = std::chrono::steady_clock::now();
+    solver.probe(std::vector<Eigen::Vector2d>(1, points[0]));
+    std::cout << "BVH build: " << seconds(start) << " s" << std::endl;
+
+    std::cout << "threads\tprobe, s\tprobes per second" << std::endl;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        setThreadsCount(threads);
+        start = std::chrono::steady_clock::now();
+        auto probes = solver.probe(points);
+        const double time = seconds(start);
+        std::cout << threads << "\t" << time << "\t" << count / time << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "contourRenderer.hpp"
+#include "meshGenerator.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+// Rasterization time of the grid and eight stress fields against the number of threads for a plate
+// Usage: bench_render [nx] [image_size] [max_threads]
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 200;
+    const int size = argc > 2 ? std::stoi(argv[2]) : 2048;
+    const int maxThreads = argc > 3 ? std::stoi(argv[3]) : getThreadsCount();
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, nx * 5 / 3);
+    Solver solver(filename, 0.3, 2.e11);
+    std::remove(filename.c_str());
+
+    auto &geometry = solver.getGeometry();
+    const std::vector<Index> connectivity = geometry.getConnectivity();
+    std::vector<Eigen::Vector2d> points;
+    for (auto &node: geometry.getNodes())
+        points.push_back(Eigen::Vector2d(node.x, node.y));
+
+    // Synthetic fields, four per element and four smoothed
+    std::vector<Field> fields(8);
+    for (int f = 0; f < 4; ++f)
+    {
+        fields[f].name = "element" + std::to_string(f);
+        for (int e = 0; e < connectivity.size() / 3; ++e)
+            fields[f].values.push_back(points[connectivity[3 * e]](0) * (f + 1) + points[connectivity[3 * e]](1));
+        fields[f + 4].name = "nodal" + std::to_string(f);
+        fields[f + 4].values = ContourRenderer::smooth(points, connectivity, fields[f].values);
+        fields[f + 4].isNodal = true;
+    }
+
+    std::cout << "Elements: " << connectivity.size() / 3 << ", image: " << size << "x" << size << std::endl;
+    std::cout << "threads\trender, s\tPNG, s" << std::endl;
+    ContourRenderer renderer(size, size);
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        setThreadsCount(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Image> images = renderer.render(points, connectivity, fields);
+        const double render = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        ContourRenderer::savePng("bench_image.png", images.back());
+        const double png = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::remove("bench_image.png");
+
+        std::cout << threads << "\t" << render << "\t" << png << std::endl;
+    }
+
+    return 0;
+}
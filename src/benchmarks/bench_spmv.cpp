@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "meshGenerator.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+#include "sparseKernels.hpp"
+
+// Assembly time and products per second of the full and the upper (half) stored stiffness matrix, rows of
+// the scatter buffers of the upper one relative to the matrix rows
+// Usage: bench_spmv [nx] [products] [max_threads]
+
+static double seconds(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 400;
+    const int products = argc > 2 ? std::stoi(argv[2]) : 100;
+    const int maxThreads = argc > 3 ? std::stoi(argv[3]) : getThreadsCount();
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, nx * 5 / 3);
+    Solver solver(filename, 0.3, 2.e11);
+    std::remove(filename.c_str());
+
+    auto start = std::chrono::steady_clock::now();
+    solver.calcuateStiffnessMatrix();
+    const double assembly = seconds(start);
+
+    const RowMajorMatrix upper = solver.getMatrix();
+    const RowMajorMatrix full = SparseMatrix(solver.getMatrix().selfadjointView<Eigen::Upper>());
+    std::cout << "DOFs: " << upper.rows() << ", non-zeros full: " << full.nonZeros() << ", upper: " << upper.nonZeros()
+              << ", assembly: " << assembly << " s" << std::endl;
+
+    const Eigen::VectorX<double> x = Eigen::VectorX<double>::Random(upper.rows());
+    Eigen::VectorX<double> y, z;
+    std::cout << "threads\tfull, 1/s\tupper, 1/s\tbuffers, rows\trelative error" << std::endl;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        setThreadsCount(threads);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < products; ++i)
+            multiply(full, x, y);
+        const double fullTime = seconds(start);
+
+        // Scatter ranges of chunks are prepared once, as the AMG solver does for its iterations
+        SymmetricProduct product;
+        product.compute(upper);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < products; ++i)
+            product.multiply(x, z);
+        const double upperTime = seconds(start);
+
+        std::cout << threads << "\t" << products / fullTime << "\t" << products / upperTime << "\t"
+                  << product.getBufferSize() / static_cast<double>(upper.rows()) << "\t" << (z - y).norm() / y.norm() << std::endl;
+    }
+
+    return 0;
+}
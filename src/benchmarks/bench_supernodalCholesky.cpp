@@ -0,0 +1,66 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "meshGenerator.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+#include "supernodalCholesky.hpp"
+
+// Factorization time of SupernodalCholesky against Eigen simplicial LDL^T
+// Usage: bench_supernodalCholesky [nx] [ny] [max_threads]
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+    const int nx = argc > 1 ? std::stoi(argv[1]) : 300;
+    const int ny = argc > 2 ? std::stoi(argv[2]) : 500;
+    const int maxThreads = argc > 3 ? std::stoi(argv[3]) : 32;
+
+    const std::string filename = "bench_plate.k";
+    writePlateMesh(filename, nx, ny);
+
+    Solver solver(filename, 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    std::remove(filename.c_str());
+
+    const auto &K = solver.getMatrix();
+    std::cout << "DOFs: " << K.rows() << ", non-zeros: " << K.nonZeros() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    LDLTSolver ldlt;
+    ldlt.compute(K);
+    const Eigen::VectorX<double> expected = ldlt.solve(solver.getLoadVector());
+    std::cout << "LDLT: " << seconds(start) << " s" << std::endl;
+
+    SupernodalCholesky cholesky;
+    start = std::chrono::steady_clock::now();
+    cholesky.analyzePattern(K);
+    std::cout << "Supernodal analysis: " << seconds(start) << " s, supernodes: " << cholesky.getSupernodesCount()
+              << ", factor entries: " << cholesky.getFactorSize() << std::endl;
+
+    std::cout << "threads\tfactorize, s\tsolve, s\trelative error" << std::endl;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        setThreadsCount(threads);
+
+        start = std::chrono::steady_clock::now();
+        cholesky.factorize(K);
+        const double factorization = seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        Eigen::VectorX<double> result = cholesky.solve(solver.getLoadVector());
+        const double solution = seconds(start);
+
+        std::cout << threads << "\t" << factorization << "\t" << solution << "\t"
+                  << (result - expected).norm() / expected.norm() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef MESH_GENERATOR_HPP
+#define MESH_GENERATOR_HPP
+
+#include <fstream>
+#include <string>
+
+/// @brief Writes structured triangular mesh of the 0.15 x 0.25 plate in *.k format
+/// @details Plate size matches default boundaries of Geometry. Nodes are enumerated from one.
+/// @param nx number of cells along x
+/// @param ny number of cells along y
+inline void writePlateMesh(const std::string &filename, int nx, int ny)
+{
+    std::ofstream output(filename);
+    if (!output.is_open())
+        throw "File not found";
+
+    output << "*NODE" << std::endl;
+    for (int j = 0; j <= ny; ++j)
+        for (int i = 0; i <= nx; ++i)
+            output << j * (nx + 1) + i + 1 << " " << 0.15 * i / nx << " " << 0.25 * j / ny << " 0 0 0" << std::endl;
+
+    output << "*ELEMENT_SHELL" << std::endl;
+    int id = 1;
+    for (int j = 0; j < ny; ++j)
+    {
+        for (int i = 0; i < nx; ++i)
+        {
+            const int n1 = j * (nx + 1) + i + 1;
+            const int n2 = n1 + 1;
+            const int n3 = n2 + nx + 1;
+            const int n4 = n1 + nx + 1;
+            output << id++ << " 1 " << n1 << " " << n2 << " " << n3 << " " << n3 << std::endl;
+            output << id++ << " 1 " << n1 << " " << n3 << " " << n4 << " " << n4 << std::endl;
+        }
+    }
+    output << "*END" << std::endl;
+}
+
+#endif /* MESH_GENERATOR_HPP */
@@ -0,0 +1,40 @@
+#include "adaptiveSolver.hpp"
+
+#include <algorithm>
+
+#include "errorEstimator.hpp"
+
+AdaptiveSolver::AdaptiveSolver(Solver &_solver, double _targetError) : solver(_solver), targetError(_targetError) {};
+
+const std::vector<AdaptiveSolver::Step>& AdaptiveSolver::run(int maxIterations)
+{
+    history.clear();
+    for (int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        solver.calcuateStiffnessMatrix();
+        solver.applyLoad();
+        solver.solve();
+
+        auto stresses = solver.calculateStress();
+        ErrorEstimator estimator(solver.getGeometry(), solver.getElasticityMatrix());
+        estimator.estimate(stresses);
+
+        Step step;
+        step.dofs = solver.getMatrix().rows();
+        step.elements = stresses.size();
+        step.relativeError = estimator.getRelativeError();
+        step.maxStress = 0.0;
+        for (auto &sigma: stresses)
+            step.maxStress = std::max(step.maxStress, sigma[3]);
+        history.push_back(step);
+
+        if (step.relativeError <= targetError || iteration == maxIterations - 1)
+            break;
+
+        auto marked = estimator.mark(targetError);
+        if (marked.empty())
+            break;
+        solver.refine(marked);
+    }
+    return history;
+}
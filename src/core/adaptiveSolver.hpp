@@ -0,0 +1,36 @@
+#ifndef ADAPTIVE_SOLVER_HPP
+#define ADAPTIVE_SOLVER_HPP
+
+#include <vector>
+
+#include "solver.hpp"
+
+/// @brief Adaptive refinement loop: solve, estimate, mark, refine
+class AdaptiveSolver
+{
+public:
+    /// @brief Statistics of a single solve
+    struct Step
+    {
+        int dofs;
+        int elements;
+        double relativeError;
+        double maxStress;   ///< maximal von Mises stress
+    };
+
+    /// @param _solver solver with loaded geometry, its geometry is refined in place
+    /// @param _targetError target relative error in energy norm, e.g. 0.05
+    AdaptiveSolver(Solver &_solver, double _targetError);
+
+    /// @brief Solves and refines until target error or iterations limit is reached
+    /// @details The solver keeps displacements of the last (finest) mesh
+    /// @return statistics of every solve
+    const std::vector<Step>& run(int maxIterations);
+
+private:
+    Solver &solver;
+    double targetError;
+    std::vector<Step> history;
+};
+
+#endif /* ADAPTIVE_SOLVER_HPP */
@@ -0,0 +1,347 @@
+#include "amgSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "parallel.hpp"
+
+/// Levels are coarsened until the matrix is smaller than this
+static const int COARSE_SIZE = 500;
+static const int MAX_LEVELS = 10;
+/// Nodes are strongly connected if ||A_ij|| >= THRESHOLD * sqrt(||A_ii|| * ||A_jj||)
+static const double STRENGTH_THRESHOLD = 0.08;
+static const int SMOOTHING_SWEEPS = 2;
+static const int POWER_ITERATIONS = 15;
+
+AmgPreconditioner::AmgPreconditioner() {};
+
+std::vector<int> AmgPreconditioner::aggregate(const RowMajorMatrix &A, int blockSize, int &aggregatesCount) const
+{
+    const int nodesCount = A.rows() / blockSize;
+
+    // Squared Frobenius norms of node blocks
+    std::vector<int> graphPtr(1, 0);
+    std::vector<int> graph;
+    std::vector<double> norms;
+    std::vector<double> diagonal(nodesCount, 0.0);
+    std::vector<int> marker(nodesCount, -1);
+    std::vector<int> position(nodesCount, -1);
+    for (int i = 0; i < nodesCount; ++i)
+    {
+        for (int row = i * blockSize; row < (i + 1) * blockSize; ++row)
+        {
+            for (RowMajorMatrix::InnerIterator it(A, row); it; ++it)
+            {
+                const int j = it.col() / blockSize;
+                if (marker[j] != i)
+                {
+                    marker[j] = i;
+                    position[j] = graph.size();
+                    graph.push_back(j);
+                    norms.push_back(0.0);
+                }
+                norms[position[j]] += it.value() * it.value();
+            }
+        }
+        if (marker[i] == i)
+            diagonal[i] = norms[position[i]];
+        graphPtr.push_back(graph.size());
+    }
+
+    // Strong connections only
+    std::vector<int> strongPtr(1, 0);
+    std::vector<int> strong;
+    std::vector<double> strength;
+    for (int i = 0; i < nodesCount; ++i)
+    {
+        for (int p = graphPtr[i]; p < graphPtr[i + 1]; ++p)
+        {
+            const int j = graph[p];
+            // Norms are squared, so is the threshold
+            if (j != i && norms[p] >= STRENGTH_THRESHOLD * STRENGTH_THRESHOLD * std::sqrt(diagonal[i] * diagonal[j]))
+            {
+                strong.push_back(j);
+                strength.push_back(norms[p]);
+            }
+        }
+        strongPtr.push_back(strong.size());
+    }
+
+    std::vector<int> aggregates(nodesCount, -1);
+    aggregatesCount = 0;
+
+    // Phase 1: a node with all strong neighbours free forms an aggregate with them
+    for (int i = 0; i < nodesCount; ++i)
+    {
+        if (aggregates[i] != -1 || strongPtr[i] == strongPtr[i + 1])
+            continue;
+        bool isFree = true;
+        for (int p = strongPtr[i]; p < strongPtr[i + 1] && isFree; ++p)
+            isFree = aggregates[strong[p]] == -1;
+        if (!isFree)
+            continue;
+
+        aggregates[i] = aggregatesCount;
+        for (int p = strongPtr[i]; p < strongPtr[i + 1]; ++p)
+            aggregates[strong[p]] = aggregatesCount;
+        ++aggregatesCount;
+    }
+
+    // Phase 2: free nodes join the most strongly connected aggregate of phase 1
+    const std::vector<int> initial = aggregates;
+    for (int i = 0; i < nodesCount; ++i)
+    {
+        if (initial[i] != -1)
+            continue;
+        double best = 0.0;
+        for (int p = strongPtr[i]; p < strongPtr[i + 1]; ++p)
+            if (initial[strong[p]] != -1 && strength[p] > best)
+            {
+                best = strength[p];
+                aggregates[i] = initial[strong[p]];
+            }
+    }
+
+    // Phase 3: the rest forms aggregates with free strong neighbours
+    for (int i = 0; i < nodesCount; ++i)
+    {
+        if (aggregates[i] != -1 || strongPtr[i] == strongPtr[i + 1])
+            continue;
+        aggregates[i] = aggregatesCount;
+        for (int p = strongPtr[i]; p < strongPtr[i + 1]; ++p)
+            if (aggregates[strong[p]] == -1)
+                aggregates[strong[p]] = aggregatesCount;
+        ++aggregatesCount;
+    }
+
+    return aggregates;
+}
+
+void AmgPreconditioner::compute(const SparseMatrix &A, const Eigen::MatrixX<double> &nullspace, int blockSize)
+{
+    levels.clear();
+
+    // Aggregation and Galerkin products need both triangles
+    RowMajorMatrix current = SparseMatrix(A.selfadjointView<Eigen::Upper>());
+    Eigen::MatrixX<double> modes = nullspace;
+    int block = blockSize;
+    while (true)
+    {
+        Level level;
+        level.A = current;
+        level.omega = 0.0;
+        level.isUpper = false;
+        level.inverseDiagonal = current.diagonal();
+        for (int i = 0; i < level.inverseDiagonal.size(); ++i)
+            level.inverseDiagonal(i) = level.inverseDiagonal(i) != 0.0 ? 1.0 / level.inverseDiagonal(i) : 0.0;
+
+        if (current.rows() <= COARSE_SIZE || levels.size() + 1 >= MAX_LEVELS)
+        {
+            levels.push_back(std::move(level));
+            break;
+        }
+
+        int aggregatesCount = 0;
+        const std::vector<int> aggregates = aggregate(current, block, aggregatesCount);
+
+        // Tentative prolongator: orthonormal basis of the near-nullspace restricted to each aggregate
+        const int modesCount = modes.cols();
+        std::vector<std::vector<int>> aggregateRows(aggregatesCount);
+        for (int node = 0; node < aggregates.size(); ++node)
+            if (aggregates[node] != -1)
+                for (int row = node * block; row < (node + 1) * block; ++row)
+                    aggregateRows[aggregates[node]].push_back(row);
+
+        std::vector<Triplet> triplets;
+        std::vector<Eigen::MatrixX<double>> coarseModes;
+        for (auto &rows: aggregateRows)
+        {
+            // Too small aggregates can not represent all modes
+            if (rows.size() < modesCount)
+                continue;
+
+            Eigen::MatrixX<double> local(rows.size(), modesCount);
+            for (int i = 0; i < rows.size(); ++i)
+                local.row(i) = modes.row(rows[i]);
+
+            Eigen::HouseholderQR<Eigen::MatrixX<double>> qr(local);
+            Eigen::MatrixX<double> Q = qr.householderQ() * Eigen::MatrixX<double>::Identity(rows.size(), modesCount);
+            const int column = coarseModes.size() * modesCount;
+            for (int i = 0; i < rows.size(); ++i)
+                for (int j = 0; j < modesCount; ++j)
+                    triplets.push_back(Triplet(rows[i], column + j, Q(i, j)));
+            coarseModes.push_back(qr.matrixQR().topRows(modesCount).triangularView<Eigen::Upper>());
+        }
+
+        const int coarseSize = coarseModes.size() * modesCount;
+        if (coarseSize == 0 || coarseSize >= 0.8 * current.rows())
+        {
+            levels.push_back(std::move(level));
+            break;
+        }
+
+        RowMajorMatrix tentative(current.rows(), coarseSize);
+        tentative.setFromTriplets(triplets.begin(), triplets.end());
+
+        // Spectral radius of D^-1 * A by power iterations, slightly overestimated to keep Jacobi stable
+        Eigen::VectorX<double> x = Eigen::VectorX<double>::Random(current.rows()), y;
+        double rho = 1.0;
+        for (int i = 0; i < POWER_ITERATIONS; ++i)
+        {
+            multiply(current, x, y);
+            y = y.cwiseProduct(level.inverseDiagonal);
+            rho = y.norm() / x.norm();
+            x = y / y.norm();
+        }
+        level.omega = 4.0 / (3.0 * 1.1 * rho);
+
+        // Smoothed prolongator P = (I - omega * D^-1 * A) * P_tent
+        RowMajorMatrix AP = current * tentative;
+        level.P = tentative - (level.omega * level.inverseDiagonal).asDiagonal() * AP;
+        level.P.prune(0.0);
+        level.R = level.P.transpose();
+
+        RowMajorMatrix RA = level.R * current;
+        RowMajorMatrix next = RA * level.P;
+        next.prune(0.0);
+        levels.push_back(std::move(level));
+
+        current = next;
+        modes.resize(coarseSize, modesCount);
+        for (int i = 0; i < coarseModes.size(); ++i)
+            modes.middleRows(i * modesCount, modesCount) = coarseModes[i];
+        block = modesCount;
+    }
+
+    levels.front().A = RowMajorMatrix(A.triangularView<Eigen::Upper>());
+    levels.front().isUpper = true;
+    product.compute(levels.front().A);
+
+    coarse.compute(SparseMatrix(levels.back().A));
+    if (coarse.info() != Eigen::Success)
+        throw "Factorization failed";
+}
+
+double AmgPreconditioner::getComplexity() const
+{
+    // Non-zeros of the full matrices, the diagonal of the upper triangle is counted once
+    auto nonZeros = [](const Level &level)
+    {
+        return level.isUpper ? 2.0 * level.A.nonZeros() - level.A.rows() : static_cast<double>(level.A.nonZeros());
+    };
+
+    double total = 0.0;
+    for (auto &level: levels)
+        total += nonZeros(level);
+    return total / nonZeros(levels.front());
+}
+
+void AmgPreconditioner::smooth(const Level &level, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &x, int sweeps) const
+{
+    Eigen::VectorX<double> r;
+    for (int sweep = 0; sweep < sweeps; ++sweep)
+    {
+        if (level.isUpper)
+            product.residual(x, b, r);
+        else
+            residual(level.A, x, b, r);
+        x += level.omega * level.inverseDiagonal.cwiseProduct(r);
+    }
+}
+
+void AmgPreconditioner::cycle(int index, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &x) const
+{
+    if (index == levels.size() - 1)
+    {
+        x = coarse.solve(b);
+        return;
+    }
+
+    const Level &level = levels[index];
+    x.setZero(b.size());
+    smooth(level, b, x, SMOOTHING_SWEEPS);
+
+    Eigen::VectorX<double> r, coarseB, coarseX, correction;
+    if (level.isUpper)
+        product.residual(x, b, r);
+    else
+        residual(level.A, x, b, r);
+    multiply(level.R, r, coarseB);
+    cycle(index + 1, coarseB, coarseX);
+    multiply(level.P, coarseX, correction);
+    x += correction;
+
+    smooth(level, b, x, SMOOTHING_SWEEPS);
+}
+
+void AmgPreconditioner::apply(const Eigen::VectorX<double> &r, Eigen::VectorX<double> &z) const
+{
+    cycle(0, r, z);
+}
+
+AmgSolver::AmgSolver(Geometry &_geometry, double _tolerance, int _maxIterations)
+    : geometry(_geometry), tolerance(_tolerance), maxIterations(_maxIterations), iterations(0) {};
+
+void AmgSolver::analyzePattern(const SparseMatrix &)
+{
+    // Hierarchy depends on values, everything is done in factorize
+}
+
+void AmgSolver::factorize(const SparseMatrix &K)
+{
+    // Rigid body modes of plane problem: two translations and rotation, coordinates are normalized
+    auto &nodes = geometry.getNodes();
+    Eigen::Vector2d lower(nodes[0].x, nodes[0].y), upper = lower;
+    for (auto &node: nodes)
+    {
+        lower = lower.cwiseMin(Eigen::Vector2d(node.x, node.y));
+        upper = upper.cwiseMax(Eigen::Vector2d(node.x, node.y));
+    }
+    const Eigen::Vector2d center = 0.5 * (lower + upper);
+    const double scale = std::max((upper - lower).maxCoeff(), 1.e-300);
+
+    Eigen::MatrixX<double> modes = Eigen::MatrixX<double>::Zero(K.rows(), 3);
+    for (auto &node: nodes)
+    {
+        const double x = (node.x - center(0)) / scale;
+        const double y = (node.y - center(1)) / scale;
+        modes.row(2 * node.id + 0) << 1.0, 0.0, -y;
+        modes.row(2 * node.id + 1) << 0.0, 1.0, x;
+    }
+
+    preconditioner.compute(K, modes, 2);
+}
+
+Eigen::VectorX<double> AmgSolver::solve(const Eigen::VectorX<double> &F) const
+{
+    const SymmetricProduct &A = preconditioner.getProduct();
+
+    Eigen::VectorX<double> x = Eigen::VectorX<double>::Zero(F.size());
+    const double norm = F.norm();
+    iterations = 0;
+    if (norm == 0.0)
+        return x;
+
+    Eigen::VectorX<double> r = F, z, q;
+    preconditioner.apply(r, z);
+    Eigen::VectorX<double> p = z;
+    double rz = r.dot(z);
+
+    while (iterations < maxIterations)
+    {
+        ++iterations;
+        A.multiply(p, q);
+        const double alpha = rz / p.dot(q);
+        x += alpha * p;
+        r -= alpha * q;
+        if (r.norm() <= tolerance * norm)
+            return x;
+
+        preconditioner.apply(r, z);
+        const double rzNext = r.dot(z);
+        p = z + (rzNext / rz) * p;
+        rz = rzNext;
+    }
+
+    throw "Iterative solver did not converge";
+}
@@ -0,0 +1,97 @@
+#ifndef AMG_SOLVER_HPP
+#define AMG_SOLVER_HPP
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include "geometry.hpp"
+#include "linearSolver.hpp"
+#include "sparseKernels.hpp"
+
+/// @brief Smoothed aggregation algebraic multigrid
+/// @details Nodes (blocks of DOFs) are aggregated by strength of connection, the tentative prolongator
+///          interpolates near-nullspace (rigid body modes on the finest level) exactly on every aggregate
+///          and is smoothed by one damped Jacobi step. Coarse operators are Galerkin products R * A * P,
+///          the coarsest one is factorized directly. A single V-cycle with parallel damped Jacobi smoothing
+///          is a symmetric positive definite preconditioner. The finest level keeps only the upper triangle
+///          of the matrix, as Solver does, and is multiplied by the symmetric kernel, whose scatter buffers
+///          are prepared once per hierarchy; the full matrix is expanded temporarily while the hierarchy is built.
+class AmgPreconditioner
+{
+public:
+    AmgPreconditioner();
+
+    /// @brief Builds the hierarchy
+    /// @param A upper triangle of the matrix of the finest level
+    /// @param nullspace near-nullspace vectors (columns), e.g. rigid body modes
+    /// @param blockSize number of DOFs per node
+    void compute(const SparseMatrix &A, const Eigen::MatrixX<double> &nullspace, int blockSize);
+
+    /// @brief Applies single V-cycle: z = M^-1 * r
+    void apply(const Eigen::VectorX<double> &r, Eigen::VectorX<double> &z) const;
+
+    int getLevelsCount() const { return levels.size(); }
+    /// @brief Operator complexity: sum of non-zeros of all levels to non-zeros of the finest one
+    double getComplexity() const;
+
+    /// @brief Upper triangle of the matrix of the finest level
+    const RowMajorMatrix& getMatrix() const { return levels.front().A; }
+    /// @brief Products with the matrix of the finest level
+    const SymmetricProduct& getProduct() const { return product; }
+
+protected:
+    struct Level
+    {
+        RowMajorMatrix A;
+        RowMajorMatrix P;   ///< prolongation from the next level
+        RowMajorMatrix R;   ///< restriction to the next level
+        Eigen::VectorX<double> inverseDiagonal;
+        double omega;       ///< Jacobi weight, 4 / (3 * rho(D^-1 * A))
+        bool isUpper;       ///< only the upper triangle of A is stored
+    };
+
+    /// @brief Aggregates nodes by strength of connection
+    /// @return aggregate of each node, -1 for nodes without strong connections
+    std::vector<int> aggregate(const RowMajorMatrix &A, int blockSize, int &aggregatesCount) const;
+
+    /// @brief Damped Jacobi sweeps x += omega * D^-1 * (b - A * x)
+    void smooth(const Level &level, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &x, int sweeps) const;
+
+    void cycle(int index, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &x) const;
+
+private:
+    std::vector<Level> levels;
+    SymmetricProduct product;   ///< products with the upper triangle of the finest level
+    Eigen::SimplicialLDLT<SparseMatrix, Eigen::Upper> coarse;
+};
+
+/// @brief Conjugate gradients preconditioned with AMG V-cycle
+/// @details The hierarchy is built by factorize and reused by every solve, e.g. for several load cases.
+class AmgSolver: public LinearSolver
+{
+public:
+    /// @param _geometry mesh used for rigid body modes, must outlive the solver
+    /// @param _tolerance relative residual norm to stop at
+    AmgSolver(Geometry &_geometry, double _tolerance = 1.e-10, int _maxIterations = 1000);
+
+    virtual void analyzePattern(const SparseMatrix &K);
+    virtual void factorize(const SparseMatrix &K);
+    virtual Eigen::VectorX<double> solve(const Eigen::VectorX<double> &F) const;
+
+    const AmgPreconditioner& getPreconditioner() const { return preconditioner; }
+    /// @brief Number of iterations of the last solve
+    int getIterations() const { return iterations; }
+
+private:
+    Geometry &geometry;
+    double tolerance;
+    int maxIterations;
+
+    AmgPreconditioner preconditioner;
+    mutable int iterations;
+};
+
+#endif /* AMG_SOLVER_HPP */
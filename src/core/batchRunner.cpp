@@ -0,0 +1,184 @@
+#include "batchRunner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+#include "parallel.hpp"
+
+/// Peak memory of the process per byte of the mesh file, measured for plates with LDLT and supernodal
+/// backends, the factor fill-in grows with the size only logarithmically
+static const size_t MEMORY_PER_MESH_BYTE = 48;
+/// Jobs estimated below this many bytes run their loops serially, about 14000 nodes
+static const size_t PARALLEL_JOB_MEMORY = 48u << 20;
+
+BatchRunner::BatchRunner(ThreadPool &_pool, size_t _memoryBudget)
+    : pool(_pool), memoryBudget(_memoryBudget), usedMemory(0), peakMemory(0)
+{
+    if (memoryBudget == 0)
+        memoryBudget = static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<size_t>(sysconf(_SC_PAGE_SIZE)) / 2;
+}
+
+std::vector<BatchRunner::Job> BatchRunner::loadManifest(const std::string &filename, const Job &defaults)
+{
+    std::ifstream input(filename);
+    if (!input.is_open())
+        throw "Manifest not found";
+
+    std::vector<Job> jobs;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream stream(line);
+        Job job = defaults;
+        if (!(stream >> job.mesh) || job.mesh[0] == '#')
+            continue;
+
+        // Material is given as a pair, the backend may follow it
+        std::vector<std::string> fields;
+        for (std::string field; stream >> field;)
+            fields.push_back(field);
+        if (fields.size() == 1 || fields.size() > 3)
+            throw "Wrong manifest line";
+        try
+        {
+            if (!fields.empty())
+            {
+                job.poissonRatio = std::stod(fields[0]);
+                job.youngModulus = std::stod(fields[1]);
+            }
+        }
+        catch (const std::exception &)
+        {
+            throw "Wrong manifest line";
+        }
+        if (fields.size() == 3)
+            job.backend = Solver::getBackendByName(fields[2]);
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+size_t BatchRunner::estimateMemory(const Job &job)
+{
+    std::ifstream input(job.mesh, std::ios::binary | std::ios::ate);
+    if (!input.is_open())
+        return 0;
+    return static_cast<size_t>(input.tellg()) * MEMORY_PER_MESH_BYTE;
+}
+
+std::vector<BatchRunner::Summary> BatchRunner::run(const std::vector<Job> &jobs, std::ostream &output)
+{
+    std::vector<Summary> summaries(jobs.size());
+    usedMemory = 0;
+    peakMemory = 0;
+
+    std::mutex outputMutex;
+    output << "Job\tMesh\tDOFs\tLoad, s\tAssembly, s\tFactorization, s\tSolve, s\tStress, s\tSx\tSy\tSxy\tS" << std::endl;
+
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+        // The main thread only admits jobs, memory is returned by the workers
+        const size_t memory = std::min(estimateMemory(jobs[i]), memoryBudget);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [this, memory] { return usedMemory + memory <= memoryBudget; });
+            usedMemory += memory;
+            peakMemory = std::max(peakMemory, usedMemory);
+        }
+
+        pool.submit([this, i, memory, &jobs, &summaries, &output, &outputMutex]
+        {
+            const Summary &summary = summaries[i] = runJob(i, jobs[i], memory);
+
+            std::ostringstream line;
+            line << summary.index << "\t" << summary.mesh << "\t";
+            if (summary.error.empty())
+            {
+                line << summary.dofs << "\t" << summary.load << "\t" << summary.assembly << "\t" << summary.factorization
+                     << "\t" << summary.solve << "\t" << summary.stress;
+                for (double value: summary.maxStress)
+                    line << "\t" << value;
+            }
+            else
+            {
+                line << "Error: " << summary.error;
+            }
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                output << line.str() << std::endl;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                usedMemory -= memory;
+            }
+            released.notify_all();
+        });
+    }
+    pool.wait();
+
+    return summaries;
+}
+
+BatchRunner::Summary BatchRunner::runJob(int index, const Job &job, size_t memory)
+{
+    Summary summary = {index, job.mesh, 0, memory, 0.0, 0.0, 0.0, 0.0, 0.0, {}, ""};
+
+    auto start = std::chrono::steady_clock::now();
+    auto lap = [&start]
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - start).count();
+        start = now;
+        return seconds;
+    };
+
+    setLocalThreadsCount(memory < PARALLEL_JOB_MEMORY ? 1 : 0);
+    try
+    {
+        Solver solver(job.poissonRatio, job.youngModulus);
+        solver.setBackend(job.backend);
+        solver.loadGeometry(job.mesh);
+        summary.load = lap();
+
+        solver.calcuateStiffnessMatrix();
+        solver.applyForces();
+        solver.applyConstraints();
+        summary.dofs = solver.getMatrix().rows();
+        summary.assembly = lap();
+
+        solver.analyzePattern();
+        solver.factorize();
+        summary.factorization = lap();
+
+        solver.solve();
+        summary.solve = lap();
+
+        const std::vector<std::vector<double>> stress = solver.calculateStress();
+        auto maxStress = std::max_element(stress.begin(), stress.end(),
+                                          [](const std::vector<double> &first, const std::vector<double> &second) { return first[3] < second[3]; });
+        if (maxStress != stress.end())
+            summary.maxStress = *maxStress;
+        summary.stress = lap();
+    }
+    catch (const char *message)
+    {
+        summary.error = message;
+    }
+    catch (const std::exception &exception)
+    {
+        summary.error = exception.what();
+    }
+    catch (...)
+    {
+        summary.error = "Unknown error";
+    }
+    setLocalThreadsCount(0);
+
+    return summary;
+}
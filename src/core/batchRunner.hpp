@@ -0,0 +1,79 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "solver.hpp"
+#include "threadPool.hpp"
+
+/// @brief Many independent static problems solved on one ThreadPool under a memory budget
+/// @details Jobs are started in the given order as soon as their estimated memory fits into the budget,
+///          a job estimated above the whole budget runs alone. Small problems run serially and many of
+///          them at once, loops of large ones are split into chunks which idle workers steal, see
+///          parallelFor. A summary line is written as soon as a job is finished, so the lines come in
+///          the order of completion and are tagged with the job index.
+class BatchRunner
+{
+public:
+    struct Job
+    {
+        std::string mesh;
+        double poissonRatio;
+        double youngModulus;
+        Solver::Backend backend;
+    };
+
+    /// @brief Result of a job, times are in seconds
+    struct Summary
+    {
+        int index;
+        std::string mesh;
+        int dofs;
+        size_t memory;          ///< estimated bytes the job was scheduled with
+        double load;
+        double assembly;
+        double factorization;
+        double solve;
+        double stress;
+        std::vector<double> maxStress;  ///< Sx, Sy, Sxy, S of the element with the largest S
+        std::string error;      ///< empty if the job succeeded
+    };
+
+    /// @param _memoryBudget bytes, zero for half of the physical memory
+    BatchRunner(ThreadPool &_pool, size_t _memoryBudget = 0);
+
+    /// @brief Reads jobs from lines "mesh [poisson young [backend]]"
+    /// @details Empty lines and lines starting with # are skipped, missing values are taken from defaults
+    static std::vector<Job> loadManifest(const std::string &filename, const Job &defaults);
+
+    /// @brief Peak memory of the job in bytes estimated from the size of its mesh file
+    static size_t estimateMemory(const Job &job);
+
+    /// @brief Runs the jobs and blocks until all of them are finished
+    /// @details Failed jobs are reported with their error and do not stop the others
+    /// @return summaries in the order of jobs
+    std::vector<Summary> run(const std::vector<Job> &jobs, std::ostream &output);
+
+    size_t getMemoryBudget() const { return memoryBudget; }
+    /// @brief Largest sum of estimates of the jobs admitted at once by the last run
+    size_t getPeakMemory() const { return peakMemory; }
+
+protected:
+    /// @brief Solves the job on the calling thread
+    static Summary runJob(int index, const Job &job, size_t memory);
+
+private:
+    ThreadPool &pool;
+    size_t memoryBudget;
+    size_t usedMemory;
+    size_t peakMemory;
+    std::mutex mutex;
+    std::condition_variable released;
+};
+
+#endif /* BATCH_RUNNER_HPP */
@@ -0,0 +1,404 @@
+#include "contourRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+#include "parallel.hpp"
+
+/// Tiles are square, a tile of 3-byte pixels of all fields fits in L2 cache
+static const int TILE_SIZE = 64;
+/// Margin around the mesh as a fraction of the image size
+static const double MARGIN = 0.05;
+/// Grid lines are drawn within this distance in pixels from element edges
+static const double LINE_HALF_WIDTH = 0.5;
+/// Largest displacement of the deformed mesh as a fraction of the mesh size
+static const double DEFORMATION_SIZE = 0.05;
+/// Deflate stored blocks are limited to 65535 bytes
+static const int STORED_BLOCK_SIZE = 65535;
+
+/// @brief Blue-green-red scale of scripts/postprocess.py, gray for constant fields
+static void colorize(double value, double lower, double upper, unsigned char *rgb)
+{
+    if (std::isnan(value))
+    {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+        return;
+    }
+    if (!(upper > lower))
+    {
+        rgb[0] = rgb[1] = rgb[2] = 128;
+        return;
+    }
+    const double v = (value - lower) / (upper - lower);
+    const double color[3] = {(v - 0.5) * 4.0, 2.0 - std::abs(v - 0.5) * 4.0, 2.0 - v * 4.0};
+    for (int i = 0; i < 3; ++i)
+        rgb[i] = static_cast<unsigned char>(std::max(0.0, std::min(1.0, color[i])) * 255.0);
+}
+
+ContourRenderer::ContourRenderer(int _width, int _height)
+    : width(std::max(1, _width)), height(std::max(1, _height)), isGridOverlay(true) {};
+
+std::vector<Image> ContourRenderer::render(const std::vector<Eigen::Vector2d> &points, const std::vector<Index> &connectivity,
+                                           const std::vector<Field> &fields) const
+{
+    const int elementsCount = connectivity.size() / 3;
+    const int fieldsCount = fields.size();
+    for (auto &field: fields)
+        if (field.values.size() != (field.isNodal ? points.size() : elementsCount))
+            throw "Wrong field size";
+
+    std::vector<Image> images(fieldsCount + 1);
+    for (auto &image: images)
+    {
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(3 * width * height, 0);
+    }
+    if (points.empty() || elementsCount == 0)
+        return images;
+
+    // Fit the mesh into the image with margins, y axis looks up
+    Eigen::Vector2d lower = points[0], upper = points[0];
+    for (auto &point: points)
+    {
+        lower = lower.cwiseMin(point);
+        upper = upper.cwiseMax(point);
+    }
+    const Eigen::Vector2d size = (upper - lower).cwiseMax(Eigen::Vector2d::Constant(1.e-300));
+    const double scale = std::min((1.0 - 2.0 * MARGIN) * width / size(0), (1.0 - 2.0 * MARGIN) * height / size(1));
+    std::vector<Eigen::Vector2d> pixels(points.size());
+    for (int i = 0; i < points.size(); ++i)
+        pixels[i] = Eigen::Vector2d(MARGIN * width + scale * (points[i](0) - lower(0)),
+                                    height - (MARGIN * height + scale * (points[i](1) - lower(1))));
+
+    // Field ranges, element colors are computed once
+    std::vector<double> lowers(fieldsCount), uppers(fieldsCount);
+    std::vector<std::vector<unsigned char>> elementColors(fieldsCount);
+    for (int f = 0; f < fieldsCount; ++f)
+    {
+        lowers[f] = std::numeric_limits<double>::max();
+        uppers[f] = std::numeric_limits<double>::lowest();
+        for (double value: fields[f].values)
+        {
+            if (std::isnan(value))
+                continue;
+            lowers[f] = std::min(lowers[f], value);
+            uppers[f] = std::max(uppers[f], value);
+        }
+        if (!fields[f].isNodal)
+        {
+            elementColors[f].resize(3 * elementsCount);
+            for (int e = 0; e < elementsCount; ++e)
+                colorize(fields[f].values[e], lowers[f], uppers[f], &elementColors[f][3 * e]);
+        }
+    }
+
+    // Bin elements to tiles by ranges of pixels with centers i + 0.5 inside their bounding boxes
+    const int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    std::vector<int> boxes(4 * elementsCount);
+    std::vector<int> tileStart(tilesX * tilesY + 1, 0);
+    for (int e = 0; e < elementsCount; ++e)
+    {
+        const Eigen::Vector2d &p0 = pixels[connectivity[3 * e]];
+        const Eigen::Vector2d &p1 = pixels[connectivity[3 * e + 1]];
+        const Eigen::Vector2d &p2 = pixels[connectivity[3 * e + 2]];
+        int *box = &boxes[4 * e];
+        box[0] = std::max(0, static_cast<int>(std::ceil(std::min({p0(0), p1(0), p2(0)}) - 0.5)));
+        box[1] = std::min(width - 1, static_cast<int>(std::floor(std::max({p0(0), p1(0), p2(0)}) - 0.5)));
+        box[2] = std::max(0, static_cast<int>(std::ceil(std::min({p0(1), p1(1), p2(1)}) - 0.5)));
+        box[3] = std::min(height - 1, static_cast<int>(std::floor(std::max({p0(1), p1(1), p2(1)}) - 0.5)));
+        for (int ty = box[2] / TILE_SIZE; box[0] <= box[1] && ty <= box[3] / TILE_SIZE; ++ty)
+            for (int tx = box[0] / TILE_SIZE; tx <= box[1] / TILE_SIZE; ++tx)
+                ++tileStart[ty * tilesX + tx + 1];
+    }
+    for (int t = 0; t < tilesX * tilesY; ++t)
+        tileStart[t + 1] += tileStart[t];
+
+    std::vector<int> tileElements(tileStart.back());
+    std::vector<int> position(tileStart.begin(), tileStart.end() - 1);
+    for (int e = 0; e < elementsCount; ++e)
+    {
+        const int *box = &boxes[4 * e];
+        for (int ty = box[2] / TILE_SIZE; box[0] <= box[1] && ty <= box[3] / TILE_SIZE; ++ty)
+            for (int tx = box[0] / TILE_SIZE; tx <= box[1] / TILE_SIZE; ++tx)
+                tileElements[position[ty * tilesX + tx]++] = e;
+    }
+
+    parallelFor(0, tilesX * tilesY, [&](int begin, int end)
+    {
+        for (int t = begin; t < end; ++t)
+        {
+            const int x0 = (t % tilesX) * TILE_SIZE, x1 = std::min(width, x0 + TILE_SIZE);
+            const int y0 = (t / tilesX) * TILE_SIZE, y1 = std::min(height, y0 + TILE_SIZE);
+            for (int k = tileStart[t]; k < tileStart[t + 1]; ++k)
+            {
+                const int e = tileElements[k];
+                const Index n[3] = {connectivity[3 * e], connectivity[3 * e + 1], connectivity[3 * e + 2]};
+                const Eigen::Vector2d &p0 = pixels[n[0]], &p1 = pixels[n[1]], &p2 = pixels[n[2]];
+                const double area = (p1(0) - p0(0)) * (p2(1) - p0(1)) - (p1(1) - p0(1)) * (p2(0) - p0(0));
+                if (std::abs(area) < 1.e-12)
+                    continue;
+
+                // Distance to the edge opposite to node i is weight i times this in pixels
+                const double heights[3] = {std::abs(area) / (p2 - p1).norm(), std::abs(area) / (p0 - p2).norm(),
+                                           std::abs(area) / (p1 - p0).norm()};
+
+                // Barycentric coordinates are linear in pixel coordinates
+                const double dw0x = (p1(1) - p2(1)) / area, dw0y = (p2(0) - p1(0)) / area;
+                const double dw1x = (p2(1) - p0(1)) / area, dw1y = (p0(0) - p2(0)) / area;
+
+                const int *box = &boxes[4 * e];
+                const int xmin = std::max(x0, box[0]), xmax = std::min(x1 - 1, box[1]);
+                const int ymin = std::max(y0, box[2]), ymax = std::min(y1 - 1, box[3]);
+
+                for (int y = ymin; y <= ymax; ++y)
+                {
+                    const double py = y + 0.5;
+                    for (int x = xmin; x <= xmax; ++x)
+                    {
+                        const double px = x + 0.5;
+                        const double w0 = (px - p2(0)) * dw0x + (py - p2(1)) * dw0y;
+                        const double w1 = (px - p2(0)) * dw1x + (py - p2(1)) * dw1y;
+                        const double w2 = 1.0 - w0 - w1;
+                        if (w0 < -1.e-9 || w1 < -1.e-9 || w2 < -1.e-9)
+                            continue;
+
+                        const size_t offset = 3 * (static_cast<size_t>(y) * width + x);
+                        const bool isLine = std::min({w0 * heights[0], w1 * heights[1], w2 * heights[2]}) <= LINE_HALF_WIDTH;
+                        const unsigned char grid = isLine ? 255 : 0;
+                        images[0].pixels[offset] = images[0].pixels[offset + 1] = images[0].pixels[offset + 2] = grid;
+
+                        for (int f = 0; f < fieldsCount; ++f)
+                        {
+                            unsigned char *rgb = &images[f + 1].pixels[offset];
+                            if (isLine && isGridOverlay)
+                            {
+                                rgb[0] = rgb[1] = rgb[2] = 0;
+                            }
+                            else if (fields[f].isNodal)
+                            {
+                                const std::vector<double> &values = fields[f].values;
+                                colorize(w0 * values[n[0]] + w1 * values[n[1]] + w2 * values[n[2]], lowers[f], uppers[f], rgb);
+                            }
+                            else
+                            {
+                                const unsigned char *color = &elementColors[f][3 * e];
+                                rgb[0] = color[0];
+                                rgb[1] = color[1];
+                                rgb[2] = color[2];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    return images;
+}
+
+std::vector<double> ContourRenderer::smooth(const std::vector<Eigen::Vector2d> &points, const std::vector<Index> &connectivity,
+                                            const std::vector<double> &values)
+{
+    std::vector<double> sums(points.size(), 0.0), weights(points.size(), 0.0);
+    for (int e = 0; e < values.size(); ++e)
+    {
+        const Eigen::Vector2d &p0 = points[connectivity[3 * e]];
+        const Eigen::Vector2d &p1 = points[connectivity[3 * e + 1]];
+        const Eigen::Vector2d &p2 = points[connectivity[3 * e + 2]];
+        const double area = 0.5 * std::abs((p1(0) - p0(0)) * (p2(1) - p0(1)) - (p1(1) - p0(1)) * (p2(0) - p0(0)));
+        for (int j = 0; j < 3; ++j)
+        {
+            sums[connectivity[3 * e + j]] += area * values[e];
+            weights[connectivity[3 * e + j]] += area;
+        }
+    }
+
+    // Nodes out of elements get no value
+    for (int i = 0; i < sums.size(); ++i)
+        sums[i] = weights[i] > 0.0 ? sums[i] / weights[i] : std::numeric_limits<double>::quiet_NaN();
+    return sums;
+}
+
+void ContourRenderer::renderStress(Geometry &geometry, const std::vector<std::vector<double>> &stress,
+                                   const Eigen::VectorX<double> &displacements, const std::string &directory) const
+{
+    auto &nodes = geometry.getNodes();
+    const std::vector<Index> connectivity = geometry.getConnectivity();
+    if (stress.size() != connectivity.size() / 3)
+        throw "Wrong stress size";
+
+    std::vector<Eigen::Vector2d> points(nodes.size());
+    for (int i = 0; i < nodes.size(); ++i)
+        points[i] = Eigen::Vector2d(nodes[i].x, nodes[i].y);
+
+    // Columns of Solver::calculateStress
+    const char *names[4] = {"Sx", "Sy", "Sxy", "S"};
+    std::vector<Field> fields(8);
+    for (int c = 0; c < 4; ++c)
+    {
+        fields[c].name = names[c];
+        fields[c].values.resize(stress.size());
+        for (int e = 0; e < stress.size(); ++e)
+            fields[c].values[e] = stress[e][c];
+        fields[c + 4].name = std::string(names[c]) + "_nodal";
+        fields[c + 4].values = smooth(points, connectivity, fields[c].values);
+        fields[c + 4].isNodal = true;
+    }
+
+    std::vector<std::string> filenames(1, directory + "/grid");
+    for (auto &field: fields)
+        filenames.push_back(directory + "/" + field.name);
+
+    std::vector<Image> images = render(points, connectivity, fields);
+    std::vector<std::string> suffixes(images.size(), "");
+
+    if (displacements.size() == 2 * nodes.size() && !nodes.empty())
+    {
+        Eigen::Vector2d lower = points[0], upper = points[0];
+        double largest = 0.0;
+        for (int i = 0; i < nodes.size(); ++i)
+        {
+            lower = lower.cwiseMin(points[i]);
+            upper = upper.cwiseMax(points[i]);
+            largest = std::max(largest, displacements.segment<2>(2 * nodes[i].id).norm());
+        }
+        const double scale = largest > 0.0 ? DEFORMATION_SIZE * (upper - lower).maxCoeff() / largest : 0.0;
+        for (int i = 0; i < nodes.size(); ++i)
+            points[i] += scale * displacements.segment<2>(2 * nodes[i].id);
+
+        std::vector<Image> deformed = render(points, connectivity, fields);
+        const int count = images.size();
+        for (int i = 0; i < count; ++i)
+        {
+            filenames.push_back(filenames[i]);
+            suffixes.push_back("_deformed");
+        }
+        images.insert(images.end(), std::make_move_iterator(deformed.begin()), std::make_move_iterator(deformed.end()));
+    }
+
+    // Images are independent, so they are encoded and written concurrently
+    std::vector<char> failed(images.size(), 0);
+    parallelFor(0, images.size(), [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            try
+            {
+                savePng(filenames[i] + suffixes[i] + ".png", images[i]);
+            }
+            catch (const char *)
+            {
+                failed[i] = 1;
+            }
+        }
+    });
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+        throw "File not found";
+}
+
+/// @brief CRC-32 of PNG chunks (polynomial 0xEDB88320)
+static uint32_t crc32(const unsigned char *data, size_t size, uint32_t crc = 0)
+{
+    static const std::vector<uint32_t> table = []
+    {
+        std::vector<uint32_t> result(256);
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            result[n] = c;
+        }
+        return result;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void appendBigEndian(std::vector<unsigned char> &buffer, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        buffer.push_back((value >> shift) & 0xff);
+}
+
+static void writeChunk(std::ofstream &output, const char *type, const std::vector<unsigned char> &data)
+{
+    std::vector<unsigned char> chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    appendBigEndian(chunk, crc32(chunk.data() + 4, data.size() + 4));
+    output.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+void ContourRenderer::savePng(const std::string &filename, const Image &image)
+{
+    std::ofstream output(filename, std::ios::binary);
+    if (!output.is_open())
+        throw "File not found";
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    output.write(reinterpret_cast<const char*>(signature), 8);
+
+    // 8 bits per channel, truecolor, no interlace
+    std::vector<unsigned char> header;
+    appendBigEndian(header, image.width);
+    appendBigEndian(header, image.height);
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+    writeChunk(output, "IHDR", header);
+
+    // Rows prefixed with filter type 0, then zlib stream of stored blocks
+    const size_t rowSize = 3 * static_cast<size_t>(image.width);
+    std::vector<unsigned char> raw;
+    raw.reserve((rowSize + 1) * image.height);
+    for (int y = 0; y < image.height; ++y)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), image.pixels.begin() + y * rowSize, image.pixels.begin() + (y + 1) * rowSize);
+    }
+
+    std::vector<unsigned char> data;
+    data.reserve(raw.size() + raw.size() / STORED_BLOCK_SIZE * 5 + 16);
+    data.push_back(0x78);
+    data.push_back(0x01);
+    size_t offset = 0;
+    do
+    {
+        const size_t length = std::min<size_t>(STORED_BLOCK_SIZE, raw.size() - offset);
+        data.push_back(offset + length == raw.size() ? 1 : 0);
+        data.push_back(length & 0xff);
+        data.push_back(length >> 8);
+        data.push_back(~length & 0xff);
+        data.push_back((~length >> 8) & 0xff);
+        data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    }
+    while (offset < raw.size());
+
+    // Adler-32 of uncompressed data, sums are reduced before they can overflow
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); )
+    {
+        const size_t end = std::min(raw.size(), i + 5552);
+        for (; i < end; ++i)
+        {
+            a += raw[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    appendBigEndian(data, (b << 16) | a);
+    writeChunk(output, "IDAT", data);
+
+    writeChunk(output, "IEND", std::vector<unsigned char>());
+}
@@ -0,0 +1,71 @@
+#ifndef CONTOUR_RENDERER_HPP
+#define CONTOUR_RENDERER_HPP
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "geometry.hpp"
+
+/// @brief RGB raster, rows from top to bottom
+struct Image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;  ///< 3 bytes per pixel
+};
+
+/// @brief Scalar field over the mesh
+struct Field
+{
+    std::string name;
+    std::vector<double> values;         ///< per element, or per node (position in Geometry::getNodes) if nodal
+    bool isNodal = false;               ///< nodal values are interpolated linearly over elements
+};
+
+/// @brief Rasterizes scalar fields of a triangle mesh to contour images
+/// @details The image is split into square tiles and triangles are binned to the tiles they overlap.
+///          Tiles are rendered by getThreadsCount() threads, each pixel of a tile is tested against
+///          its triangles once and the barycentric coordinates are shared by all fields and the grid,
+///          so a single mesh traversal produces every image. Colors follow the blue-green-red scale of
+///          scripts/postprocess.py over the range of each field. Images are saved as PNG.
+class ContourRenderer
+{
+public:
+    /// @param _width, _height image size in pixels, the mesh is fitted with 5% margins
+    ContourRenderer(int _width = 1024, int _height = 1024);
+
+    /// @brief Draws element edges over the fields
+    void setGridOverlay(bool _isGridOverlay) { isGridOverlay = _isGridOverlay; }
+
+    /// @brief Renders the grid and the fields
+    /// @param points node coordinates in the order of Geometry::getNodes
+    /// @param connectivity three node positions per element, see Geometry::getConnectivity
+    /// @return grid image (white edges on black) followed by an image of every field
+    std::vector<Image> render(const std::vector<Eigen::Vector2d> &points, const std::vector<Index> &connectivity,
+                              const std::vector<Field> &fields) const;
+
+    /// @brief Renders Sx, Sy, Sxy and von Mises stress of elements and their smoothed nodal fields
+    /// @details Saves grid.png, Sx.png, Sy.png, Sxy.png, S.png and Sx_nodal.png etc. to the existing
+    ///          directory. With displacements the deformed mesh is rendered too, to files with _deformed
+    ///          suffix, displacements are scaled to 5% of the mesh size.
+    /// @param stress rows of Solver::calculateStress
+    /// @param displacements global displacements or empty vector
+    void renderStress(Geometry &geometry, const std::vector<std::vector<double>> &stress,
+                      const Eigen::VectorX<double> &displacements, const std::string &directory) const;
+
+    /// @brief Area weighted averages of element values at nodes
+    static std::vector<double> smooth(const std::vector<Eigen::Vector2d> &points, const std::vector<Index> &connectivity,
+                                      const std::vector<double> &values);
+
+    /// @brief Writes 8-bit RGB PNG with stored (uncompressed) deflate blocks
+    static void savePng(const std::string &filename, const Image &image);
+
+private:
+    int width;
+    int height;
+    bool isGridOverlay;
+};
+
+#endif /* CONTOUR_RENDERER_HPP */
@@ -0,0 +1,296 @@
+#include "domainDecomposition.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+#include "parallel.hpp"
+
+/// Number of interface columns processed at once while building the Schur complement
+static const int SCHUR_BLOCK_SIZE = 64;
+
+DomainDecompositionSolver::DomainDecompositionSolver(Geometry &_geometry, int _subdomainsCount)
+    : geometry(_geometry), subdomainsCount(std::max(1, _subdomainsCount)) {};
+
+void DomainDecompositionSolver::bisect(std::vector<int> &order, const std::vector<Eigen::Vector2d> &centroids,
+                                       int begin, int end, int firstPart, int partsCount)
+{
+    if (partsCount == 1 || end - begin < 2)
+    {
+        for (int i = begin; i < end; ++i)
+            elementParts[order[i]] = firstPart;
+        return;
+    }
+
+    Eigen::Vector2d lower = centroids[order[begin]];
+    Eigen::Vector2d upper = lower;
+    for (int i = begin; i < end; ++i)
+    {
+        lower = lower.cwiseMin(centroids[order[i]]);
+        upper = upper.cwiseMax(centroids[order[i]]);
+    }
+    const int axis = (upper - lower)(0) > (upper - lower)(1) ? 0 : 1;
+
+    // Parts count may be not a power of two, so the cut is proportional
+    const int leftParts = partsCount / 2;
+    const int middle = begin + static_cast<long long>(end - begin) * leftParts / partsCount;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                     [&centroids, axis](int lhs, int rhs) { return centroids[lhs](axis) < centroids[rhs](axis); });
+
+    bisect(order, centroids, begin, middle, firstPart, leftParts);
+    bisect(order, centroids, middle, end, firstPart + leftParts, partsCount - leftParts);
+}
+
+void DomainDecompositionSolver::analyzePattern(const SparseMatrix &K)
+{
+    auto &elements = geometry.getElements();
+    const int dofsCount = K.rows();
+
+    // Partition elements
+    std::vector<Eigen::Vector2d> centroids(elements.size());
+    for (int i = 0; i < elements.size(); ++i)
+    {
+        centroids[i].setZero();
+        for (int j = 0; j < 3; ++j)
+            centroids[i] += Eigen::Vector2d(elements[i]->getNode(j).x, elements[i]->getNode(j).y) / 3.0;
+    }
+
+    const int partsCount = std::max(1, std::min<int>(subdomainsCount, elements.size()));
+    elementParts.assign(elements.size(), 0);
+    std::vector<int> order(elements.size());
+    std::iota(order.begin(), order.end(), 0);
+    bisect(order, centroids, 0, elements.size(), 0, partsCount);
+
+    // Classify nodes: -2 is untouched, -1 is shared by several subdomains
+    std::vector<int> nodeParts(dofsCount / 2, -2);
+    for (int i = 0; i < elements.size(); ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            int &part = nodeParts[elements[i]->getNode(j).id];
+            if (part == -2)
+                part = elementParts[i];
+            else if (part != elementParts[i])
+                part = -1;
+        }
+    }
+
+    subdomains = std::vector<Subdomain>(partsCount);
+    interfaceDofs.clear();
+    dofParts.resize(dofsCount);
+    localIndices.resize(dofsCount);
+    for (int dof = 0; dof < dofsCount; ++dof)
+    {
+        // Nodes out of any element go to interface, so they are still solved
+        const int part = std::max(-1, nodeParts[dof / 2]);
+        dofParts[dof] = part;
+        if (part >= 0)
+        {
+            localIndices[dof] = subdomains[part].dofs.size();
+            subdomains[part].dofs.push_back(dof);
+        }
+        else
+        {
+            localIndices[dof] = interfaceDofs.size();
+            interfaceDofs.push_back(dof);
+        }
+    }
+
+    // Interface DOFs coupled with each subdomain, the coupling is stored in either triangle
+    for (int k = 0; k < K.outerSize(); ++k)
+    {
+        for (SparseMatrix::InnerIterator it(K, k); it; ++it)
+        {
+            if (dofParts[k] == -1 && dofParts[it.row()] >= 0)
+                subdomains[dofParts[it.row()]].interface.push_back(localIndices[k]);
+            else if (dofParts[k] >= 0 && dofParts[it.row()] == -1)
+                subdomains[dofParts[k]].interface.push_back(localIndices[it.row()]);
+        }
+    }
+    for (auto &subdomain: subdomains)
+    {
+        std::sort(subdomain.interface.begin(), subdomain.interface.end());
+        subdomain.interface.erase(std::unique(subdomain.interface.begin(), subdomain.interface.end()), subdomain.interface.end());
+    }
+
+    extractBlocks(K);
+
+    parallelFor(0, partsCount, [this](int begin, int end)
+    {
+        for (int p = begin; p < end; ++p)
+            if (!subdomains[p].dofs.empty())
+                subdomains[p].ldlt.analyzePattern(subdomains[p].Kii);
+    });
+}
+
+void DomainDecompositionSolver::extractBlocks(const SparseMatrix &K)
+{
+    const int interfaceSize = interfaceDofs.size();
+
+    std::vector<std::vector<int>> interfaceLocal(subdomains.size());
+    std::vector<std::vector<Triplet>> interiorTriplets(subdomains.size());
+    std::vector<std::vector<Triplet>> couplingTriplets(subdomains.size());
+    std::vector<Triplet> interfaceTriplets;
+
+    for (int p = 0; p < subdomains.size(); ++p)
+    {
+        interfaceLocal[p].assign(interfaceSize, -1);
+        for (int i = 0; i < subdomains[p].interface.size(); ++i)
+            interfaceLocal[p][subdomains[p].interface[i]] = i;
+    }
+
+    for (int k = 0; k < K.outerSize(); ++k)
+    {
+        const int colPart = dofParts[k];
+        for (SparseMatrix::InnerIterator it(K, k); it; ++it)
+        {
+            const int rowPart = dofParts[it.row()];
+            const int row = localIndices[it.row()];
+            const int col = localIndices[k];
+
+            // Local numbering is monotone, so the diagonal blocks stay upper triangular
+            if (rowPart >= 0 && colPart == rowPart)
+                interiorTriplets[rowPart].push_back(Triplet(row, col, it.value()));
+            else if (rowPart >= 0 && colPart == -1)
+                couplingTriplets[rowPart].push_back(Triplet(row, interfaceLocal[rowPart][col], it.value()));
+            else if (rowPart == -1 && colPart >= 0)
+                couplingTriplets[colPart].push_back(Triplet(col, interfaceLocal[colPart][row], it.value()));
+            else if (rowPart == -1 && colPart == -1)
+                interfaceTriplets.push_back(Triplet(row, col, it.value()));
+            else if (rowPart >= 0 && colPart >= 0 && it.value() != 0.0)
+                throw "Interior DOFs of different subdomains are coupled";
+        }
+    }
+
+    parallelFor(0, subdomains.size(), [&](int begin, int end)
+    {
+        for (int p = begin; p < end; ++p)
+        {
+            Subdomain &subdomain = subdomains[p];
+            subdomain.Kii.resize(subdomain.dofs.size(), subdomain.dofs.size());
+            subdomain.Kii.setFromTriplets(interiorTriplets[p].begin(), interiorTriplets[p].end());
+            subdomain.KiG.resize(subdomain.dofs.size(), subdomain.interface.size());
+            subdomain.KiG.setFromTriplets(couplingTriplets[p].begin(), couplingTriplets[p].end());
+        }
+    });
+
+    KGG.resize(interfaceSize, interfaceSize);
+    KGG.setFromTriplets(interfaceTriplets.begin(), interfaceTriplets.end());
+}
+
+void DomainDecompositionSolver::factorize(const SparseMatrix &K)
+{
+    extractBlocks(K);
+
+    std::atomic<bool> failed(false);
+    std::vector<std::vector<Triplet>> schurTriplets(subdomains.size());
+
+    parallelFor(0, subdomains.size(), [&](int begin, int end)
+    {
+        for (int p = begin; p < end; ++p)
+        {
+            Subdomain &subdomain = subdomains[p];
+            if (subdomain.dofs.empty())
+                continue;
+
+            subdomain.ldlt.factorize(subdomain.Kii);
+            if (subdomain.ldlt.info() != Eigen::Success)
+            {
+                failed = true;
+                continue;
+            }
+
+            // Local contribution K_Gi * K_ii^-1 * K_iG, a block of columns at a time to bound memory
+            const int localSize = subdomain.interface.size();
+            for (int first = 0; first < localSize; first += SCHUR_BLOCK_SIZE)
+            {
+                const int width = std::min(SCHUR_BLOCK_SIZE, localSize - first);
+                Eigen::MatrixX<double> X = subdomain.ldlt.solve(Eigen::MatrixX<double>(subdomain.KiG.middleCols(first, width)));
+                // The contribution is symmetric, rows after the block belong to the lower triangle
+                Eigen::MatrixX<double> C = subdomain.KiG.leftCols(first + width).transpose() * X;
+
+                for (int j = 0; j < width; ++j)
+                    for (int i = 0; i <= first + j; ++i)
+                        if (C(i, j) != 0.0)
+                            schurTriplets[p].push_back(Triplet(subdomain.interface[i], subdomain.interface[first + j], -C(i, j)));
+            }
+        }
+    });
+
+    if (failed)
+        throw "Factorization failed";
+
+    std::vector<Triplet> triplets;
+    for (int k = 0; k < KGG.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(KGG, k); it; ++it)
+            triplets.push_back(Triplet(it.row(), it.col(), it.value()));
+    for (auto &local: schurTriplets)
+        triplets.insert(triplets.end(), local.begin(), local.end());
+
+    SparseMatrix S(KGG.rows(), KGG.cols());
+    S.setFromTriplets(triplets.begin(), triplets.end());
+
+    schur.compute(S);
+    if (schur.info() != Eigen::Success)
+        throw "Factorization failed";
+}
+
+Eigen::VectorX<double> DomainDecompositionSolver::solve(const Eigen::VectorX<double> &F) const
+{
+    const int interfaceSize = interfaceDofs.size();
+
+    // Condense interior loads onto interface
+    std::vector<Eigen::VectorX<double>> condensed(subdomains.size());
+    parallelFor(0, subdomains.size(), [&](int begin, int end)
+    {
+        for (int p = begin; p < end; ++p)
+        {
+            const Subdomain &subdomain = subdomains[p];
+            if (subdomain.dofs.empty())
+                continue;
+
+            Eigen::VectorX<double> Fi(subdomain.dofs.size());
+            for (int i = 0; i < subdomain.dofs.size(); ++i)
+                Fi(i) = F(subdomain.dofs[i]);
+            condensed[p] = subdomain.KiG.transpose() * subdomain.ldlt.solve(Fi);
+        }
+    });
+
+    Eigen::VectorX<double> G(interfaceSize);
+    for (int i = 0; i < interfaceSize; ++i)
+        G(i) = F(interfaceDofs[i]);
+    for (int p = 0; p < subdomains.size(); ++p)
+        for (int i = 0; i < condensed[p].size(); ++i)
+            G(subdomains[p].interface[i]) -= condensed[p](i);
+
+    const Eigen::VectorX<double> uG = interfaceSize > 0 ? Eigen::VectorX<double>(schur.solve(G)) : G;
+
+    Eigen::VectorX<double> x(F.size());
+    for (int i = 0; i < interfaceSize; ++i)
+        x(interfaceDofs[i]) = uG(i);
+
+    // Back substitution for interior DOFs
+    parallelFor(0, subdomains.size(), [&](int begin, int end)
+    {
+        for (int p = begin; p < end; ++p)
+        {
+            const Subdomain &subdomain = subdomains[p];
+            if (subdomain.dofs.empty())
+                continue;
+
+            Eigen::VectorX<double> localG(subdomain.interface.size());
+            for (int i = 0; i < subdomain.interface.size(); ++i)
+                localG(i) = uG(subdomain.interface[i]);
+
+            Eigen::VectorX<double> Fi(subdomain.dofs.size());
+            for (int i = 0; i < subdomain.dofs.size(); ++i)
+                Fi(i) = F(subdomain.dofs[i]);
+
+            Eigen::VectorX<double> ui = subdomain.ldlt.solve(Fi - subdomain.KiG * localG);
+            for (int i = 0; i < subdomain.dofs.size(); ++i)
+                x(subdomain.dofs[i]) = ui(i);
+        }
+    });
+
+    return x;
+}
@@ -0,0 +1,66 @@
+#ifndef DOMAIN_DECOMPOSITION_HPP
+#define DOMAIN_DECOMPOSITION_HPP
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include "geometry.hpp"
+#include "linearSolver.hpp"
+
+/// @brief Substructuring (Schur complement) solver
+/// @details Elements are split into subdomains with recursive coordinate bisection.
+///          DOFs of nodes shared by several subdomains form the interface, the rest are interior.
+///          Interior blocks are factorized in parallel, one subdomain per task, then the interface
+///          Schur complement S = K_GG - sum(K_Gi * K_ii^-1 * K_iG) is assembled as a sparse matrix
+///          and factorized directly. Like the global matrix, all blocks keep the upper triangle only.
+class DomainDecompositionSolver: public LinearSolver
+{
+public:
+    /// @param _geometry mesh used for partitioning, must outlive the solver
+    /// @param _subdomainsCount number of subdomains, usually not less than number of threads
+    DomainDecompositionSolver(Geometry &_geometry, int _subdomainsCount);
+
+    virtual void analyzePattern(const SparseMatrix &K);
+    virtual void factorize(const SparseMatrix &K);
+    virtual Eigen::VectorX<double> solve(const Eigen::VectorX<double> &F) const;
+
+    /// @brief Subdomain of each element, available after analyzePattern
+    const std::vector<int>& getElementParts() const { return elementParts; }
+    /// @brief Number of interface DOFs, available after analyzePattern
+    int getInterfaceSize() const { return interfaceDofs.size(); }
+
+protected:
+    /// @brief Splits elements [begin, end) of the order into parts [firstPart, firstPart + partsCount)
+    void bisect(std::vector<int> &order, const std::vector<Eigen::Vector2d> &centroids,
+                int begin, int end, int firstPart, int partsCount);
+
+    /// @brief Extracts interior and coupling blocks from global matrix
+    void extractBlocks(const SparseMatrix &K);
+
+private:
+    struct Subdomain
+    {
+        std::vector<int> dofs;          ///< global indices of interior DOFs
+        std::vector<int> interface;     ///< global interface indices (into interfaceDofs) coupled with the subdomain
+        SparseMatrix Kii; ///< upper triangle of interior block
+        SparseMatrix KiG; ///< interior to local interface coupling
+        Eigen::SimplicialLDLT<SparseMatrix, Eigen::Upper> ldlt;
+    };
+
+    Geometry &geometry;
+    int subdomainsCount;
+
+    std::vector<int> elementParts;
+    std::vector<int> dofParts;      ///< subdomain of DOF or -1 for interface DOF
+    std::vector<int> localIndices;  ///< index of DOF inside its subdomain or inside interface
+    std::vector<int> interfaceDofs; ///< global indices of interface DOFs
+
+    std::vector<Subdomain> subdomains;
+    SparseMatrix KGG; ///< upper triangle of interface block
+    Eigen::SimplicialLDLT<SparseMatrix, Eigen::Upper> schur;
+};
+
+#endif /* DOMAIN_DECOMPOSITION_HPP */
@@ -6,13 +6,15 @@
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include "types.hpp"
+
 struct Node
 {
-    Node(double _x, double _y, int _id) : x(_x), y(_y), id(_id) {}
+    Node(double _x, double _y, Index _id) : x(_x), y(_y), id(_id) {}
 
     double x;
     double y;
-    int id;
+    Index id;
 };
 
 
@@ -26,7 +28,10 @@ public:
 
     virtual double getSquare() const = 0;
 
-    virtual std::vector<Eigen::Triplet<double>> calculateStiffnessMatrix(const Eigen::Matrix3d & D) const = 0;
+    virtual std::vector<Triplet> calculateStiffnessMatrix(const Eigen::Matrix3d & D) const = 0;
+
+    /// @brief Entries of the stiffness matrix with global row not greater than global column
+    virtual std::vector<Triplet> calculateUpperStiffnessMatrix(const Eigen::Matrix3d & D) const = 0;
 
     virtual std::vector<double> calculateStress(const Eigen::VectorX<double> & displacements, const Eigen::Matrix3d& D) const = 0;
 
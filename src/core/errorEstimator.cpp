@@ -0,0 +1,77 @@
+#include "errorEstimator.hpp"
+
+#include <cmath>
+
+ErrorEstimator::ErrorEstimator(Geometry &_geometry, const Eigen::Matrix3d &D)
+    : geometry(_geometry), compliance(D.inverse()), errorNorm2(0.0), energyNorm2(0.0) {};
+
+const std::vector<double>& ErrorEstimator::estimate(const std::vector<std::vector<double>> &stresses)
+{
+    auto &elements = geometry.getElements();
+    const int nodesCount = geometry.getNodes().size();
+
+    if (stresses.size() != elements.size())
+        throw "Stresses do not match elements";
+
+    // Recovery by area-weighted averaging of adjacent elements
+    nodalStresses.assign(nodesCount, Eigen::Vector3d::Zero());
+    std::vector<double> weights(nodesCount, 0.0);
+    for (int i = 0; i < elements.size(); ++i)
+    {
+        const double square = elements[i]->getSquare();
+        const Eigen::Vector3d sigma(stresses[i][0], stresses[i][1], stresses[i][2]);
+        for (int j = 0; j < 3; ++j)
+        {
+            const Index id = elements[i]->getNode(j).id;
+            nodalStresses[id] += square * sigma;
+            weights[id] += square;
+        }
+    }
+    for (int i = 0; i < nodesCount; ++i)
+        if (weights[i] > 0.0)
+            nodalStresses[i] /= weights[i];
+
+    // Exact integration of the quadratic form over triangle: int(Ni * Nj) = A * (1 + delta_ij) / 12
+    errors.resize(elements.size());
+    errorNorm2 = 0.0;
+    energyNorm2 = 0.0;
+    for (int i = 0; i < elements.size(); ++i)
+    {
+        const double square = elements[i]->getSquare();
+        const Eigen::Vector3d sigma(stresses[i][0], stresses[i][1], stresses[i][2]);
+
+        double error2 = 0.0;
+        Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+        for (int j = 0; j < 3; ++j)
+        {
+            const Eigen::Vector3d e = nodalStresses[elements[i]->getNode(j).id] - sigma;
+            error2 += e.dot(compliance * e);
+            sum += e;
+        }
+        error2 = square / 12.0 * (error2 + sum.dot(compliance * sum));
+
+        errors[i] = std::sqrt(error2);
+        errorNorm2 += error2;
+        energyNorm2 += square * sigma.dot(compliance * sigma);
+    }
+
+    return errors;
+}
+
+double ErrorEstimator::getRelativeError() const
+{
+    if (errorNorm2 + energyNorm2 == 0.0)
+        return 0.0;
+    return std::sqrt(errorNorm2 / (errorNorm2 + energyNorm2));
+}
+
+std::vector<int> ErrorEstimator::mark(double targetError) const
+{
+    const double permissible = targetError * std::sqrt((energyNorm2 + errorNorm2) / errors.size());
+
+    std::vector<int> marked;
+    for (int i = 0; i < errors.size(); ++i)
+        if (errors[i] > permissible)
+            marked.push_back(i);
+    return marked;
+}
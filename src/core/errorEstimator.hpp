@@ -0,0 +1,47 @@
+#ifndef ERROR_ESTIMATOR_HPP
+#define ERROR_ESTIMATOR_HPP
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "geometry.hpp"
+
+/// @brief Zienkiewicz-Zhu a posteriori error estimator
+/// @details Element stresses are recovered to nodes by area-weighted averaging, the difference between
+///          the recovered (linear) and the element (constant) stress field is measured in energy norm.
+class ErrorEstimator
+{
+public:
+    /// @param _geometry mesh the stresses were calculated for
+    /// @param D elasticity matrix
+    ErrorEstimator(Geometry &_geometry, const Eigen::Matrix3d &D);
+
+    /// @brief Estimates errors
+    /// @param stresses element stresses Sx, Sy, Sxy (extra columns are ignored), see Solver::calculateStress
+    /// @return energy norm of error for each element
+    const std::vector<double>& estimate(const std::vector<std::vector<double>> &stresses);
+
+    /// @brief Recovered nodal stresses Sx, Sy, Sxy indexed by node id, available after estimate
+    const std::vector<Eigen::Vector3d>& getNodalStresses() const { return nodalStresses; }
+
+    /// @brief Relative error: ||e|| / sqrt(||u||^2 + ||e||^2) in energy norm, available after estimate
+    double getRelativeError() const;
+
+    /// @brief Marks elements exceeding the permissible error
+    /// @details Error is treated as permissible when it is evenly distributed over elements and the
+    ///          relative error equals the target one.
+    /// @return indices of elements to refine
+    std::vector<int> mark(double targetError) const;
+
+private:
+    Geometry &geometry;
+    Eigen::Matrix3d compliance; ///< inverse of elasticity matrix
+
+    std::vector<Eigen::Vector3d> nodalStresses;
+    std::vector<double> errors;
+    double errorNorm2;  ///< squared energy norm of error
+    double energyNorm2; ///< squared energy norm of solution
+};
+
+#endif /* ERROR_ESTIMATOR_HPP */
@@ -0,0 +1,307 @@
+#include "explicitSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <memory>
+
+#include "linearTriangle.hpp"
+#include "parallel.hpp"
+#include "threadPool.hpp"
+
+/// Fraction of the critical time step
+static const double TIME_STEP_SAFETY = 0.8;
+/// Smaller ranges are not split between threads, starting threads would cost more than the loop
+static const int MIN_PARALLEL_RANGE = 4096;
+
+/// @brief parallelFor for ranges large enough
+static void forRange(int begin, int end, const std::function<void(int, int)> &body)
+{
+    if (end - begin < MIN_PARALLEL_RANGE)
+        body(begin, end);
+    else
+        parallelFor(begin, end, body);
+}
+
+ExplicitSolver::ExplicitSolver(Geometry &_geometry, const Eigen::Matrix3d &_D, double density)
+    : geometry(_geometry), D(_D), alpha(0.0), time(0.0)
+{
+    auto &elements = geometry.getElements();
+    const int elementsCount = elements.size();
+    const Index dofsCount = 2 * geometry.getNodes().size();
+
+    // Greedy coloring: elements of the same color share no nodes
+    std::vector<Index> nodeElementsPtr(dofsCount / 2 + 1, 0);
+    for (auto element: elements)
+        for (int j = 0; j < 3; ++j)
+            ++nodeElementsPtr[element->getNode(j).id + 1];
+    for (Index i = 0; i < dofsCount / 2; ++i)
+        nodeElementsPtr[i + 1] += nodeElementsPtr[i];
+    std::vector<int> nodeElements(nodeElementsPtr.back());
+    std::vector<Index> position(nodeElementsPtr.begin(), nodeElementsPtr.end() - 1);
+    for (int e = 0; e < elementsCount; ++e)
+        for (int j = 0; j < 3; ++j)
+            nodeElements[position[elements[e]->getNode(j).id]++] = e;
+
+    std::vector<int> colors(elementsCount, -1);
+    std::vector<int> forbidden;
+    int colorsCount = 0;
+    for (int e = 0; e < elementsCount; ++e)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const Index node = elements[e]->getNode(j).id;
+            for (Index k = nodeElementsPtr[node]; k < nodeElementsPtr[node + 1]; ++k)
+                if (colors[nodeElements[k]] != -1)
+                    forbidden.push_back(colors[nodeElements[k]]);
+        }
+        std::sort(forbidden.begin(), forbidden.end());
+        int color = 0;
+        for (int used: forbidden)
+            if (used == color)
+                ++color;
+        colors[e] = color;
+        colorsCount = std::max(colorsCount, color + 1);
+        forbidden.clear();
+    }
+
+    colorStart.assign(colorsCount + 1, 0);
+    for (int color: colors)
+        ++colorStart[color + 1];
+    for (int c = 0; c < colorsCount; ++c)
+        colorStart[c + 1] += colorStart[c];
+    std::vector<int> order(elementsCount);
+    position.assign(colorStart.begin(), colorStart.end() - 1);
+    for (int e = 0; e < elementsCount; ++e)
+        order[position[colors[e]]++] = e;
+
+    // Structure of arrays in color order, lumped mass and critical time step
+    for (int j = 0; j < 3; ++j)
+    {
+        nodes[j].resize(elementsCount);
+        dNdx[j].resize(elementsCount);
+        dNdy[j].resize(elementsCount);
+    }
+    areas.resize(elementsCount);
+    masses = Eigen::VectorX<double>::Zero(dofsCount);
+    double minAltitude = std::numeric_limits<double>::max();
+    for (int k = 0; k < elementsCount; ++k)
+    {
+        const LinearTriangleElement *element = dynamic_cast<const LinearTriangleElement*>(elements[order[k]]);
+        if (!element)
+            throw "Unsupported element";
+
+        const auto &B = element->getB();
+        areas[k] = element->getSquare();
+        double longest = 0.0;
+        for (int j = 0; j < 3; ++j)
+        {
+            const Node &a = element->getNode(j), &b = element->getNode((j + 1) % 3);
+            nodes[j][k] = a.id;
+            dNdx[j][k] = B(0, 2 * j);
+            dNdy[j][k] = B(1, 2 * j + 1);
+            masses(2 * a.id + 0) += density * areas[k] / 3.0;
+            masses(2 * a.id + 1) += density * areas[k] / 3.0;
+            longest = std::max(longest, std::hypot(a.x - b.x, a.y - b.y));
+        }
+        if (longest > 0.0)
+            minAltitude = std::min(minAltitude, 2.0 * areas[k] / longest);
+    }
+
+    // Dilatational wave speed of plane stress, D(0, 0) = E / (1 - nu^2)
+    const double speed = std::sqrt(D(0, 0) / density);
+    stableTimeStep = elementsCount > 0 ? TIME_STEP_SAFETY * minAltitude / speed : 0.0;
+    timeStep = stableTimeStep;
+
+    // Nodes out of elements have no mass, they are kept fixed
+    isConstrained.assign(dofsCount, 0);
+    for (Index i = 0; i < dofsCount; ++i)
+        if (masses(i) == 0.0)
+            isConstrained[i] = 1;
+    for (auto &boundary: geometry.getBoundaries())
+    {
+        for (auto &node: boundary.nodes)
+        {
+            if (node.type == BoundaryNode::UX || node.type == BoundaryNode::UXY)
+                isConstrained[2 * node.node + 0] = 1;
+            if (node.type == BoundaryNode::UY || node.type == BoundaryNode::UXY)
+                isConstrained[2 * node.node + 1] = 1;
+        }
+    }
+
+    load = Eigen::VectorX<double>::Zero(dofsCount);
+    displacements = Eigen::VectorX<double>::Zero(dofsCount);
+    velocities = Eigen::VectorX<double>::Zero(dofsCount);
+}
+
+void ExplicitSolver::setLoad(const Eigen::VectorX<double> &_load)
+{
+    if (_load.size() != load.size())
+        throw "Wrong load vector size";
+    load = _load;
+}
+
+void ExplicitSolver::calculateInternalForces(const Eigen::VectorX<double> &u, Eigen::VectorX<double> &f) const
+{
+    f.setZero(u.size());
+    const double d00 = D(0, 0), d01 = D(0, 1), d11 = D(1, 1), d22 = D(2, 2);
+    const double *uData = u.data();
+    double *fData = f.data();
+
+    for (int color = 0; color + 1 < colorStart.size(); ++color)
+    {
+        // Elements of a color have distinct nodes, so threads scatter without conflicts
+        forRange(colorStart[color], colorStart[color + 1], [&](int begin, int end)
+        {
+            const Index *n0 = nodes[0].data(), *n1 = nodes[1].data(), *n2 = nodes[2].data();
+            const double *bx0 = dNdx[0].data(), *bx1 = dNdx[1].data(), *bx2 = dNdx[2].data();
+            const double *by0 = dNdy[0].data(), *by1 = dNdy[1].data(), *by2 = dNdy[2].data();
+            const double *area = areas.data();
+            for (int e = begin; e < end; ++e)
+            {
+                const double ux0 = uData[2 * n0[e]], uy0 = uData[2 * n0[e] + 1];
+                const double ux1 = uData[2 * n1[e]], uy1 = uData[2 * n1[e] + 1];
+                const double ux2 = uData[2 * n2[e]], uy2 = uData[2 * n2[e] + 1];
+
+                // Strain B * u and stress D * strain, times area
+                const double exx = bx0[e] * ux0 + bx1[e] * ux1 + bx2[e] * ux2;
+                const double eyy = by0[e] * uy0 + by1[e] * uy1 + by2[e] * uy2;
+                const double gxy = by0[e] * ux0 + by1[e] * ux1 + by2[e] * ux2 + bx0[e] * uy0 + bx1[e] * uy1 + bx2[e] * uy2;
+                const double sxx = area[e] * (d00 * exx + d01 * eyy);
+                const double syy = area[e] * (d01 * exx + d11 * eyy);
+                const double sxy = area[e] * d22 * gxy;
+
+                // B^T * stress
+                fData[2 * n0[e]] += bx0[e] * sxx + by0[e] * sxy;
+                fData[2 * n0[e] + 1] += by0[e] * syy + bx0[e] * sxy;
+                fData[2 * n1[e]] += bx1[e] * sxx + by1[e] * sxy;
+                fData[2 * n1[e] + 1] += by1[e] * syy + bx1[e] * sxy;
+                fData[2 * n2[e]] += bx2[e] * sxx + by2[e] * sxy;
+                fData[2 * n2[e] + 1] += by2[e] * syy + bx2[e] * sxy;
+            }
+        });
+    }
+}
+
+int ExplicitSolver::run(double endTime, double snapshotInterval, const std::string &prefix)
+{
+    if (endTime <= time)
+        return 0;
+    if (timeStep <= 0.0)
+        throw "Wrong time step";
+
+    // Steps are equal and not longer than the time step
+    const int steps = static_cast<int>(std::ceil((endTime - time) / timeStep));
+    const double dt = (endTime - time) / steps;
+    const int dofsCount = displacements.size();
+
+    // Snapshots are written by a background thread while integration goes on
+    ThreadPool writer(1);
+    bool failed = false;
+    int snapshot = 0;
+    double nextSnapshot = time;
+    auto saveSnapshot = [&]()
+    {
+        if (snapshotInterval <= 0.0 || time < nextSnapshot - 1.e-12 * snapshotInterval)
+            return;
+        std::shared_ptr<Eigen::VectorX<double>> copy(new Eigen::VectorX<double>(displacements));
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "_%04d.txt", snapshot++);
+        const std::string filename = prefix + suffix;
+        writer.submit([this, copy, filename, &failed]
+        {
+            std::ofstream output(filename);
+            if (!output.is_open())
+            {
+                failed = true;
+                return;
+            }
+            const Index shift = geometry.getShift();
+            for (auto &node: geometry.getNodes())
+                output << node.id + shift << " " << (*copy)(2 * node.id) << " " << (*copy)(2 * node.id + 1) << std::endl;
+        });
+        while (nextSnapshot <= time + 1.e-12 * snapshotInterval)
+            nextSnapshot += snapshotInterval;
+    };
+
+    Eigen::VectorX<double> f;
+    auto integrate = [&]()
+    {
+        calculateInternalForces(displacements, f);
+        saveSnapshot();
+
+        for (int step = 0; step < steps; ++step)
+        {
+            // Velocities live at half steps, the first update is a half one
+            const double velocityStep = time == 0.0 && velocities.isZero(0.0) ? 0.5 * dt : dt;
+            const double damping = 0.5 * alpha * velocityStep;
+            forRange(0, dofsCount, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    if (isConstrained[i])
+                    {
+                        velocities(i) = 0.0;
+                        continue;
+                    }
+                    const double acceleration = (load(i) - f(i)) / masses(i);
+                    velocities(i) = ((1.0 - damping) * velocities(i) + velocityStep * acceleration) / (1.0 + damping);
+                    displacements(i) += dt * velocities(i);
+                }
+            });
+            time += dt;
+
+            calculateInternalForces(displacements, f);
+            saveSnapshot();
+        }
+    };
+
+    // Loops of all steps run on one pool, so parallelFor reuses its workers instead of starting threads
+    const int threads = getThreadsCount();
+    if (threads > 1 && !ThreadPool::getCurrent())
+    {
+        ThreadPool pool(threads);
+        std::exception_ptr error;
+        pool.submit([&]()
+        {
+            setLocalThreadsCount(threads);
+            try
+            {
+                integrate();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        });
+        pool.wait();
+        if (error)
+            std::rethrow_exception(error);
+    }
+    else
+    {
+        integrate();
+    }
+
+    // The flag is set by the writer thread only
+    writer.wait();
+    if (failed)
+        throw "File not found";
+    return steps;
+}
+
+void ExplicitSolver::save(const std::string &filename) const
+{
+    std::ofstream output;
+    output.open(filename);
+
+    if (!output.is_open())
+        throw "File not found";
+
+    const Index shift = geometry.getShift();
+    for (auto &node: geometry.getNodes())
+        output << node.id + shift << " " << displacements(2 * node.id) << " " << displacements(2 * node.id + 1) << std::endl;
+}
@@ -0,0 +1,80 @@
+#ifndef EXPLICIT_SOLVER_HPP
+#define EXPLICIT_SOLVER_HPP
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "geometry.hpp"
+
+/// @brief Explicit central difference time integration of elastodynamics M * a + C * v + K * u = F
+/// @details Mass is lumped to nodes, so no system is solved. Internal forces are computed element by
+///          element from B matrices stored as structure of arrays, there is no global matrix. Elements are
+///          colored so that elements of the same color share no nodes, each color is a contiguous range
+///          processed by getThreadsCount() threads without atomics. The time step is limited by the CFL
+///          condition. Constraints of the geometry boundaries keep DOFs fixed.
+class ExplicitSolver
+{
+public:
+    /// @param _geometry mesh of linear triangles with boundaries, must outlive the solver
+    /// @param D elasticity matrix, see Solver::getElasticityMatrix
+    /// @param density mass per unit volume, unit thickness is assumed as for the stiffness
+    ExplicitSolver(Geometry &_geometry, const Eigen::Matrix3d &D, double density);
+
+    /// @brief External forces, constant in time
+    void setLoad(const Eigen::VectorX<double> &load);
+    /// @brief Mass proportional damping C = alpha * M
+    void setDamping(double _alpha) { alpha = _alpha; }
+    /// @brief Overrides the time step, it is not checked against the stable one
+    void setTimeStep(double _timeStep) { timeStep = _timeStep; }
+
+    /// @brief Stable time step: safety factor times minimal element altitude over dilatational wave speed
+    double getStableTimeStep() const { return stableTimeStep; }
+    double getTimeStep() const { return timeStep; }
+
+    /// @brief Integrates until the end time
+    /// @param snapshotInterval displacements are saved every interval of time, 0 disables snapshots
+    /// @param prefix snapshots are saved to prefix_NNNN.txt in the Solver::save format, written in background;
+    ///        a snapshot which can't be written fails the run after integration
+    /// @return number of steps
+    int run(double endTime, double snapshotInterval = 0.0, const std::string &prefix = "snapshot");
+
+    /// @brief Internal forces f = K * u, computed element by element
+    void calculateInternalForces(const Eigen::VectorX<double> &u, Eigen::VectorX<double> &f) const;
+
+    /// @brief Saves displacements in the Solver::save format
+    void save(const std::string &filename) const;
+
+    const Eigen::VectorX<double>& getDisplacements() const { return displacements; }
+    const Eigen::VectorX<double>& getVelocities() const { return velocities; }
+    const Eigen::VectorX<double>& getMasses() const { return masses; }
+    double getTime() const { return time; }
+    int getColorsCount() const { return colorStart.size() - 1; }
+
+private:
+    Geometry &geometry;
+    Eigen::Matrix3d D;
+    double alpha;
+
+    /// @brief Elements ordered by color, structure of arrays
+    /// @{
+    std::vector<int> colorStart;            ///< first element of each color, the last is elements count
+    std::vector<Index> nodes[3];            ///< node ids
+    std::vector<double> dNdx[3];            ///< shape function derivatives, B matrix entries
+    std::vector<double> dNdy[3];
+    std::vector<double> areas;
+    /// @}
+
+    Eigen::VectorX<double> masses;          ///< lumped mass of each DOF
+    Eigen::VectorX<double> load;
+    std::vector<char> isConstrained;
+
+    Eigen::VectorX<double> displacements;
+    Eigen::VectorX<double> velocities;      ///< at half steps
+    double time;
+    double timeStep;
+    double stableTimeStep;
+};
+
+#endif /* EXPLICIT_SOLVER_HPP */
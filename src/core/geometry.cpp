@@ -1,17 +1,37 @@
 #include "geometry.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <fstream>
+#include <limits>
+#include <map>
 #include <string>
 #include <sstream>
+#include <unordered_set>
 
 #include <iostream>
 
 #include "element.hpp"
 #include "linearTriangle.hpp"
+#include "nodeGrid.hpp"
 
 using namespace std;
 
-Geometry::Geometry() : shift(INT_MAX) {};
+/// Edge by its end node ids, the smaller one first
+typedef pair<Index, Index> EdgeKey;
+
+struct EdgeKeyHash
+{
+    size_t operator()(const EdgeKey &key) const { return hash<Index>()(key.first) * 1000003u ^ hash<Index>()(key.second); }
+};
+
+static EdgeKey edgeKey(Index a, Index b)
+{
+    return EdgeKey(min(a, b), max(a, b));
+}
+
+Geometry::Geometry() : shift(numeric_limits<Index>::max()) {};
 
 void Geometry::loadFromFile(const string &filename)
 {
@@ -21,39 +41,72 @@ void Geometry::loadFromFile(const string &filename)
     if (!input.is_open())
         throw "File not found";
     
-    bool isParsingNodes=false;
-    bool isParsingElements=false;
+    enum Section
+    {
+        NONE,
+        NODES,
+        ELEMENTS,
+        SET_LIST,
+        SET_BOX,
+        SET_SEGMENT,
+        SPC_SET,
+        LOAD_NODE,
+        LOAD_NODE_SET,
+        LOAD_EDGE_SET
+    };
+    const map<string, Section> sections = {
+        {"*NODE", NODES},
+        {"*ELEMENT_SHELL", ELEMENTS},
+        {"*SET_NODE", SET_LIST},
+        {"*SET_NODE_LIST", SET_LIST},
+        {"*SET_NODE_BOX", SET_BOX},
+        {"*SET_NODE_SEGMENT", SET_SEGMENT},
+        {"*BOUNDARY_SPC_SET", SPC_SET},
+        {"*LOAD_NODE", LOAD_NODE},
+        {"*LOAD_NODE_POINT", LOAD_NODE},
+        {"*LOAD_NODE_SET", LOAD_NODE_SET},
+        {"*LOAD_EDGE_SET", LOAD_EDGE_SET}
+    };
+
+    // Loads of single nodes get their own sets with negative ids
+    int pointSets = 0;
+    auto load = [this](int set, int dof, double value, bool distributed)
+    {
+        if (dof != 1 && dof != 2)
+            throw "Unsupported DOF";
+        loads.push_back({set, dof == 1 ? value : 0.0, dof == 2 ? value : 0.0, distributed});
+    };
+
+    Section section = NONE;
+    int listSet = -1;
     string line;
     while (getline(input, line))
     {
-        if (line.find("*NODE") == 0)
-        {
-            isParsingNodes = true;
-            isParsingElements = false;
+        if (line.empty() || line[0] == '$')
             continue;
-        }
-        
-        if (line.find("*ELEMENT_SHELL") == 0)
+
+        if (line[0] == '*')
         {
-            
-            isParsingElements = true;
-            isParsingNodes = false;
-            applyNodesShift();
+            // Nodes are shifted once, when their section is over
+            if (section == NODES)
+                applyNodesShift();
+
+            auto it = sections.find(line.substr(0, line.find_first_of(" \t\r")));
+            section = it != sections.end() ? it->second : NONE;
+            listSet = -1;
             continue;
         }
-        if (line[0] == '$')
-            continue;
 
         istringstream input_line(move(line));
 
-        if (isParsingNodes)
+        if (section == NODES)
         {
-            int id;
+            Index id;
             double x,y;
 
             if (! (input_line >> id >> x >> y))
             {
-                isParsingNodes = false;
+                section = NONE;
                 applyNodesShift();
                 continue;
             }
@@ -63,13 +116,13 @@ void Geometry::loadFromFile(const string &filename)
             continue;
         }
 
-        if (isParsingElements)
+        if (section == ELEMENTS)
         {
             int id;
             int pid;
             if (!(input_line >> id >> pid))
             {
-                isParsingElements = false;
+                section = NONE;
                 continue;
             }
 
@@ -77,30 +130,408 @@ void Geometry::loadFromFile(const string &filename)
             if (pid == pid)
             {
                 
-                int i, j, k;
+                Index i, j, k;
                 input_line >> i >> j >> k;
                 elements.push_back(new LinearTriangleElement(getNode(i), getNode(j), getNode(k)));
             }
+            continue;
+        }
+
+        if (section == SET_LIST)
+        {
+            // The first card is the set id, the rest are node ids
+            Index id;
+            if (listSet == -1)
+            {
+                if (input_line >> listSet)
+                    nodeSets[listSet].type = NodeSet::LIST;
+                continue;
+            }
+            while (input_line >> id)
+                if (id > 0)
+                    nodeSets[listSet].ids.push_back(id);
+            continue;
+        }
+
+        if (section == SET_BOX || section == SET_SEGMENT)
+        {
+            int id;
+            NodeSet set;
+            set.type = section == SET_BOX ? NodeSet::BOX : NodeSet::SEGMENT;
+            const int count = section == SET_BOX ? 4 : 5;
+            if (!(input_line >> id))
+                continue;
+            for (int i=0; i<count; ++i)
+                if (!(input_line >> set.region[i]))
+                    throw "Wrong node set region";
+            nodeSets[id] = set;
+            continue;
+        }
+
+        if (section == SPC_SET)
+        {
+            int set, cid, dofx = 0, dofy = 0;
+            if (input_line >> set >> cid >> dofx)
+            {
+                input_line >> dofy;
+                constraints.push_back({set, dofx != 0, dofy != 0});
+            }
+            continue;
+        }
+
+        if (section == LOAD_NODE)
+        {
+            Index id;
+            int dof;
+            double value;
+            if (input_line >> id >> dof >> value)
+            {
+                const int set = -(++pointSets);
+                nodeSets[set].ids.push_back(id);
+                load(set, dof, value, false);
+            }
+            continue;
+        }
 
+        if (section == LOAD_NODE_SET || section == LOAD_EDGE_SET)
+        {
+            int set, dof;
+            double value;
+            if (input_line >> set >> dof >> value)
+                load(set, dof, value, section == LOAD_EDGE_SET);
+            continue;
         }
     }
 
+    if (section == NODES)
+        applyNodesShift();
+
+    for (auto &set: nodeSets)
+    {
+        set.second.nodes.clear();
+        for (Index id: set.second.ids)
+            set.second.nodes.push_back(getNode(id).id);
+    }
+
     createBoundaries();
 };
 
 
-Node& Geometry::getNode(int id)
+void Geometry::saveToFile(const string &filename)
 {
-    for (int i=0; i<nodes.size(); ++i)
-        if (nodes[i].id == id - shift)
-            return nodes[i];
-    throw "No found found";
+    ofstream output;
+    output.open(filename);
+
+    if (!output.is_open())
+        throw "File not found";
+
+    output << "*NODE" << endl;
+    for (auto &node: nodes)
+        output << node.id + shift << " " << node.x << " " << node.y << " 0 0 0" << endl;
+
+    output << "*ELEMENT_SHELL" << endl;
+    for (int i=0; i<elements.size(); ++i)
+    {
+        output << i + 1 << " 1";
+        for (int j=0; j<3; ++j)
+            output << " " << elements[i]->getNode(j).id + shift;
+        output << " " << elements[i]->getNode(2).id + shift << endl;
+    }
+    output << "*END" << endl;
+}
+
+void Geometry::refine(const vector<int> &markedElements)
+{
+    struct Edge
+    {
+        Index middle = -1;              ///< id of the middle node, -1 if edge is not marked
+        int elements[2] = {-1, -1};
+    };
+
+    auto node = [this](Index id) -> Node& { return nodes[nodeIndices[id]]; };
+
+    vector<array<Index, 3>> triangles(elements.size());
+    unordered_map<EdgeKey, Edge, EdgeKeyHash> edges;
+    for (int i=0; i<elements.size(); ++i)
+    {
+        for (int j=0; j<3; ++j)
+            triangles[i][j] = elements[i]->getNode(j).id;
+        for (int j=0; j<3; ++j)
+        {
+            Edge &edge = edges[edgeKey(triangles[i][j], triangles[i][(j + 1) % 3])];
+            edge.elements[edge.elements[0] == -1 ? 0 : 1] = i;
+        }
+    }
+
+    // Local index of the longest edge start, ties are broken by ids to keep neighbours consistent
+    auto longest = [&](const array<Index, 3> &t)
+    {
+        int result = 0;
+        double resultLength = -1.0;
+        EdgeKey resultKey(-1, -1);
+        for (int j=0; j<3; ++j)
+        {
+            const Node &a = node(t[j]), &b = node(t[(j + 1) % 3]);
+            const double length = (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+            const EdgeKey key = edgeKey(t[j], t[(j + 1) % 3]);
+            if (length > resultLength || (length == resultLength && key > resultKey))
+            {
+                result = j;
+                resultLength = length;
+                resultKey = key;
+            }
+        }
+        return result;
+    };
+
+    // Boundary neighbours of boundary nodes, used to keep curved boundaries curved
+    unordered_map<Index, vector<Index>> outline;
+    for (auto &edge: edges)
+    {
+        if (edge.second.elements[1] != -1)
+            continue;
+        const Index a = edge.first.first, b = edge.first.second;
+        outline[a].push_back(b);
+        outline[b].push_back(a);
+    }
+
+    // Middle of the edge, boundary edges are interpolated with circular arcs along smooth parts of the boundary
+    auto middle = [&](Index a, Index b)
+    {
+        Eigen::Vector2d first(node(a).x, node(a).y), second(node(b).x, node(b).y);
+        Eigen::Vector2d result = 0.5 * (first + second);
+
+        auto neighbour = [&](Index v, Index other) -> Index
+        {
+            auto it = outline.find(v);
+            if (it == outline.end() || it->second.size() != 2)
+                return -1;
+            return it->second[0] == other ? it->second[1] : it->second[0];
+        };
+        if (edges[edgeKey(a, b)].elements[1] != -1)
+            return result;
+
+        // A side is smooth if the boundary turns there by less than 60 degrees, so coarse arcs are still arcs
+        const Eigen::Vector2d direction = (second - first).normalized();
+        const double smooth = cos(M_PI / 3.0);
+        const Index before = neighbour(a, b), after = neighbour(b, a);
+        Eigen::Vector2d previous, next;
+        bool isPreviousSmooth = false, isNextSmooth = false;
+        if (before != -1)
+        {
+            previous = Eigen::Vector2d(node(before).x, node(before).y);
+            isPreviousSmooth = (first - previous).normalized().dot(direction) > smooth;
+        }
+        if (after != -1)
+        {
+            next = Eigen::Vector2d(node(after).x, node(after).y);
+            isNextSmooth = (next - second).normalized().dot(direction) > smooth;
+        }
+
+        // Middle of the arc through three points, the chord middle if points are collinear
+        auto arc = [&](const Eigen::Vector2d &p, const Eigen::Vector2d &q, const Eigen::Vector2d &r) -> Eigen::Vector2d
+        {
+            const Eigen::Vector2d u = q - p, v = r - p;
+            const double cross = u(0) * v(1) - u(1) * v(0);
+            if (std::abs(cross) < 1.e-8 * u.norm() * v.norm())
+                return result;
+            const Eigen::Vector2d center = p + (u.squaredNorm() * Eigen::Vector2d(v(1), -v(0)) - v.squaredNorm() * Eigen::Vector2d(u(1), -u(0))) / (2.0 * cross);
+            return center + (result - center).normalized() * (first - center).norm();
+        };
+
+        // Arcs are interpolated exactly, straight lines stay straight
+        if (isPreviousSmooth && isNextSmooth)
+            return Eigen::Vector2d(0.5 * (arc(previous, first, second) + arc(first, second, next)));
+        if (isPreviousSmooth)
+            return arc(previous, first, second);
+        if (isNextSmooth)
+            return arc(first, second, next);
+        return result;
+    };
+
+    // Marking and closure: every element with a bisected edge must have its longest edge bisected
+    vector<int> queue;
+    auto mark = [&](Index a, Index b)
+    {
+        Edge &edge = edges[edgeKey(a, b)];
+        if (edge.middle != -1)
+            return;
+        const Eigen::Vector2d position = middle(a, b);
+        const Index id = nodes.size();
+        nodes.push_back(Node(position(0), position(1), id));
+        nodeIndices[id] = nodes.size() - 1;
+        edge.middle = id;
+        for (int element: edge.elements)
+            if (element != -1)
+                queue.push_back(element);
+    };
+
+    for (int i: markedElements)
+        for (int j=0; j<3; ++j)
+            mark(triangles[i][j], triangles[i][(j + 1) % 3]);
+
+    while (!queue.empty())
+    {
+        const auto &t = triangles[queue.back()];
+        queue.pop_back();
+        const int j = longest(t);
+        mark(t[j], t[(j + 1) % 3]);
+    }
+
+    // Bisection patterns, the first cut always goes through the longest edge
+    vector<array<Index, 3>> refined;
+    refined.reserve(triangles.size() + 3 * markedElements.size());
+    for (auto &t: triangles)
+    {
+        const int j = longest(t);
+        const Index v0 = t[j], v1 = t[(j + 1) % 3], v2 = t[(j + 2) % 3];
+        const Index m = edges[edgeKey(v0, v1)].middle;
+        if (m == -1)
+        {
+            refined.push_back(t);
+            continue;
+        }
+
+        const Index p = edges[edgeKey(v1, v2)].middle;
+        const Index q = edges[edgeKey(v2, v0)].middle;
+
+        if (q == -1)
+            refined.push_back({v0, m, v2});
+        else
+        {
+            refined.push_back({v0, m, q});
+            refined.push_back({m, v2, q});
+        }
+
+        if (p == -1)
+            refined.push_back({m, v1, v2});
+        else
+        {
+            refined.push_back({m, v1, p});
+            refined.push_back({m, p, v2});
+        }
+    }
+
+    // Node lists get middles of bisected edges between their nodes
+    for (auto &set: nodeSets)
+    {
+        if (set.second.type != NodeSet::LIST)
+            continue;
+        unordered_set<Index> members(set.second.nodes.begin(), set.second.nodes.end());
+        for (auto &edge: edges)
+            if (edge.second.middle != -1 && members.count(edge.first.first) && members.count(edge.first.second))
+                set.second.nodes.push_back(edge.second.middle);
+    }
+
+    for (auto element: elements)
+        delete element;
+    elements.clear();
+    for (auto &t: refined)
+        elements.push_back(new LinearTriangleElement(node(t[0]), node(t[1]), node(t[2])));
+
+    boundaries.clear();
+    createBoundaries();
+}
+
+Node& Geometry::getNode(Index id)
+{
+    auto it = nodeIndices.find(id - shift);
+    if (it == nodeIndices.end())
+        throw "No found found";
+    return nodes[it->second];
+}
+
+vector<Index> Geometry::getConnectivity()
+{
+    vector<Index> result;
+    result.reserve(3 * elements.size());
+    for (auto element: elements)
+        for (int j=0; j<3; ++j)
+            result.push_back(&element->getNode(j) - nodes.data());
+    return result;
+}
+
+vector<array<Index, 2>> Geometry::getBoundaryEdges()
+{
+    unordered_map<EdgeKey, array<Index, 2>, EdgeKeyHash> edges;
+    for (auto element: elements)
+    {
+        for (int j=0; j<3; ++j)
+        {
+            const Index a = element->getNode(j).id, b = element->getNode((j + 1) % 3).id;
+            const EdgeKey key = edgeKey(a, b);
+            auto it = edges.find(key);
+            if (it == edges.end())
+                edges[key] = {a, b};
+            else
+                edges.erase(it);
+        }
+    }
+
+    vector<array<Index, 2>> result;
+    result.reserve(edges.size());
+    for (auto &edge: edges)
+        result.push_back(edge.second);
+    sort(result.begin(), result.end());
+    return result;
 }
 
 void Geometry::createBoundaries()
 {
+    NodeGrid grid;
+    grid.build(nodes);
+    for (auto &set: nodeSets)
+    {
+        const double *r = set.second.region;
+        vector<Index> found;
+        if (set.second.type == NodeSet::BOX)
+            found = grid.findInBox(r[0], r[1], r[2], r[3]);
+        else if (set.second.type == NodeSet::SEGMENT)
+            found = grid.findNearSegment(r[0], r[1], r[2], r[3], r[4]);
+        else
+            continue;
+
+        set.second.nodes.clear();
+        for (Index i: found)
+            set.second.nodes.push_back(nodes[i].id);
+    }
+
+    auto setNodes = [this](int id) -> const vector<Index>&
+    {
+        auto it = nodeSets.find(id);
+        if (it == nodeSets.end())
+            throw "Node set not found";
+        return it->second.nodes;
+    };
+
+    if (!constraints.empty() || !loads.empty())
+    {
+        for (auto &constraint: constraints)
+        {
+            if (!constraint.x && !constraint.y)
+                continue;
+            const BoundaryNode::Type type = constraint.x && constraint.y ? BoundaryNode::UXY : (constraint.x ? BoundaryNode::UX : BoundaryNode::UY);
+            Boundary boundary;
+            for (Index node: setNodes(constraint.set))
+                boundary.nodes.push_back(BoundaryNode(type, node));
+            boundaries.push_back(boundary);
+        }
+
+        for (auto &load: loads)
+        {
+            Boundary boundary;
+            boundary.fx = load.fx;
+            boundary.fy = load.fy;
+            boundary.distributed = load.distributed;
+            for (Index node: setNodes(load.set))
+                boundary.nodes.push_back(BoundaryNode(BoundaryNode::F, node));
+            boundaries.push_back(boundary);
+        }
+        return;
+    }
+
     boundaries.resize(3);
-    for (int i=0; i<nodes.size(); ++i)
+    for (Index i=0; i<nodes.size(); ++i)
     {
         if (nodes[i].x < 1.e-10)
         {
@@ -121,10 +552,16 @@ void Geometry::createBoundaries()
     auto & force = boundaries[2].nodes;
     std::sort(force.begin(), force.end(), 
               [this](BoundaryNode lhs, BoundaryNode rhs) { return this->getNode(lhs.node + this->shift).y < this->getNode(rhs.node + this->shift).y; });
+    boundaries[2].fx = 1000000.0;
+    boundaries[2].distributed = true;
 }
 
 void Geometry::applyNodesShift() 
 {
     for (auto &node: nodes)
         node.id -= shift;
+
+    nodeIndices.clear();
+    for (Index i=0; i<nodes.size(); ++i)
+        nodeIndices[nodes[i].id] = i;
 }
@@ -1,6 +1,8 @@
 #ifndef GEOMETRY_HPP
 #define GEOMETRY_HPP
 
+#include <array>
+#include <map>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -17,15 +19,35 @@ struct BoundaryNode
         F
     };
 
-    BoundaryNode(Type _type, int _node) : type(_type), node(_node) {}
+    BoundaryNode(Type _type, Index _node) : type(_type), node(_node) {}
 
     Type type;
-    int node;
+    Index node;
 };
 
 struct Boundary
 {
     std::vector<BoundaryNode> nodes;
+
+    double fx = 0.0;            ///< force applied to F nodes
+    double fy = 0.0;
+    bool distributed = false;   ///< force is per unit length of boundary edges between F nodes, otherwise per node
+};
+
+/// @brief Node set defined by *SET_NODE_LIST, *SET_NODE_BOX or *SET_NODE_SEGMENT keyword
+struct NodeSet
+{
+    enum Type
+    {
+        LIST,
+        BOX,        ///< XMIN XMAX YMIN YMAX
+        SEGMENT     ///< X1 Y1 X2 Y2 TOL
+    };
+
+    Type type = LIST;
+    double region[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    std::vector<Index> ids;     ///< node ids as in the file, LIST only
+    std::vector<Index> nodes;   ///< resolved (shifted) node ids
 };
 
 class Geometry
@@ -33,20 +55,48 @@ class Geometry
 public:
     Geometry();
 
+    /// @brief Loads mesh from *.k file
+    /// @details Supported keywords are *NODE, *ELEMENT_SHELL, node sets *SET_NODE(_LIST) (SID, then node ids),
+    ///          *SET_NODE_BOX (SID XMIN XMAX YMIN YMAX), *SET_NODE_SEGMENT (SID X1 Y1 X2 Y2 TOL),
+    ///          constraints *BOUNDARY_SPC_SET (NSID CID DOFX DOFY) and loads *LOAD_NODE (NID DOF SF),
+    ///          *LOAD_NODE_SET (NSID DOF SF, force per node), *LOAD_EDGE_SET (NSID DOF SF, force per unit
+    ///          length of boundary edges), DOF is 1 for x and 2 for y. Without constraints and loads
+    ///          default boundaries are created, see createBoundaries.
     void loadFromFile(const std::string &filename);
 
+    /// @brief Saves nodes and elements in the same *.k format
+    void saveToFile(const std::string &filename);
+
+    /// @brief Refines marked elements with conforming longest edge bisection
+    /// @details All edges of marked elements are bisected. Neighbours are bisected through their longest
+    ///          edge until no hanging nodes remain. Middles of boundary edges on smooth parts of the boundary
+    ///          are placed on circular arcs through neighbouring boundary nodes, so curved
+    ///          boundaries are not flattened. New nodes get next free ids, elements and boundaries are
+    ///          recreated, so references to old elements and nodes are invalidated.
+    /// @param markedElements indices of elements to refine
+    void refine(const std::vector<int> &markedElements);
+
     /// @name Getters
     /// @{ 
     std::vector<Element*>& getElements() { return elements; }
     std::vector<Node>& getNodes() { return nodes; }
     std::vector<Boundary>& getBoundaries() { return boundaries; }
-    int getShift() { return shift; }
+    const std::map<int, NodeSet>& getNodeSets() { return nodeSets; }
+    Index getShift() { return shift; }
     /// @}
 
-    Node& getNode(int id);
+    Node& getNode(Index id);
+
+    /// @brief Edges belonging to a single element
+    std::vector<std::array<Index, 2>> getBoundaryEdges();
+
+    /// @brief Nodes of elements, three per element, as positions in getNodes()
+    std::vector<Index> getConnectivity();
 protected:
     /// @brief Create boundaries
-    /// @details BICYCLE
+    /// @details Region node sets are resolved through NodeGrid and every *BOUNDARY_SPC_SET and *LOAD_*
+    ///          keyword becomes a boundary. Without them the plate defaults are used (BICYCLE):
+    ///          x is fixed at x = 0, y is fixed at y = 0 and 1e6 traction is applied at x = 0.15.
     void createBoundaries();
 
     /// @details Fixes meshes, which enumerate nodes not from zero (Hello, my FortRan friend)
@@ -55,8 +105,29 @@ private:
     std::vector<Node> nodes;
     std::vector<Element*> elements;
     std::vector<Boundary> boundaries;
+    std::unordered_map<Index, Index> nodeIndices; ///< node position in nodes by shifted id
+
+    /// @brief Boundary condition keywords
+    /// @{
+    struct SetConstraint
+    {
+        int set;
+        bool x;
+        bool y;
+    };
+    struct SetLoad
+    {
+        int set;
+        double fx;
+        double fy;
+        bool distributed;
+    };
+    std::map<int, NodeSet> nodeSets;
+    std::vector<SetConstraint> constraints;
+    std::vector<SetLoad> loads;
+    /// @}
 
-    int shift;
+    Index shift;
 };
 
 #endif /* GEOMETRY_HPP */
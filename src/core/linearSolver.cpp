@@ -0,0 +1,18 @@
+#include "linearSolver.hpp"
+
+void LDLTSolver::analyzePattern(const SparseMatrix &K)
+{
+    ldlt.analyzePattern(K);
+}
+
+void LDLTSolver::factorize(const SparseMatrix &K)
+{
+    ldlt.factorize(K);
+    if (ldlt.info() != Eigen::Success)
+        throw "Factorization failed";
+}
+
+Eigen::VectorX<double> LDLTSolver::solve(const Eigen::VectorX<double> &F) const
+{
+    return ldlt.solve(F);
+}
@@ -0,0 +1,45 @@
+#ifndef LINEAR_SOLVER_HPP
+#define LINEAR_SOLVER_HPP
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include "types.hpp"
+
+/// @brief Interface of the sparse symmetric positive definite system solver
+/// @details Factorization is split into symbolic (pattern only) and numeric parts,
+///          so the solver can be refactorized when only matrix values are changed.
+///          Only the upper triangle of the matrix is read, see Solver::getMatrix.
+class LinearSolver
+{
+public:
+    virtual ~LinearSolver() {};
+
+    /// @brief Symbolic analysis, depends on sparsity pattern only
+    virtual void analyzePattern(const SparseMatrix &K) = 0;
+    /// @brief Numeric factorization, the pattern of K must be the one passed to analyzePattern
+    virtual void factorize(const SparseMatrix &K) = 0;
+
+    void compute(const SparseMatrix &K)
+    {
+        analyzePattern(K);
+        factorize(K);
+    }
+
+    /// @brief Solves K * x = F using the computed factorization
+    virtual Eigen::VectorX<double> solve(const Eigen::VectorX<double> &F) const = 0;
+};
+
+/// @brief Eigen simplicial LDL^T, single-threaded
+class LDLTSolver: public LinearSolver
+{
+public:
+    virtual void analyzePattern(const SparseMatrix &K);
+    virtual void factorize(const SparseMatrix &K);
+    virtual Eigen::VectorX<double> solve(const Eigen::VectorX<double> &F) const;
+
+private:
+    Eigen::SimplicialLDLT<SparseMatrix, Eigen::Upper> ldlt;
+};
+
+#endif /* LINEAR_SOLVER_HPP */
@@ -55,19 +55,19 @@ double LinearTriangleElement::getSquare() const
     return 0.5 * std::abs(det);
 }
 
-std::vector<Eigen::Triplet<double>> LinearTriangleElement::calculateStiffnessMatrix(const Eigen::Matrix3d &D) const
+std::vector<Triplet> LinearTriangleElement::calculateStiffnessMatrix(const Eigen::Matrix3d &D) const
 {
     Eigen::Matrix<double, 6, 6> K = B.transpose() * D * B * getSquare();
 
-    std::vector<Eigen::Triplet<double>> triplets;
+    std::vector<Triplet> triplets;
     for (int i = 0; i < 3; i++)
     {
         for (int j = 0; j < 3; j++)
         {
-            Eigen::Triplet<double> trplt11(2 * nodes[i] + 0, 2 * nodes[j] + 0, K(2 * i + 0, 2 * j + 0));
-            Eigen::Triplet<double> trplt12(2 * nodes[i] + 0, 2 * nodes[j] + 1, K(2 * i + 0, 2 * j + 1));
-            Eigen::Triplet<double> trplt21(2 * nodes[i] + 1, 2 * nodes[j] + 0, K(2 * i + 1, 2 * j + 0));
-            Eigen::Triplet<double> trplt22(2 * nodes[i] + 1, 2 * nodes[j] + 1, K(2 * i + 1, 2 * j + 1));
+            Triplet trplt11(2 * nodes[i] + 0, 2 * nodes[j] + 0, K(2 * i + 0, 2 * j + 0));
+            Triplet trplt12(2 * nodes[i] + 0, 2 * nodes[j] + 1, K(2 * i + 0, 2 * j + 1));
+            Triplet trplt21(2 * nodes[i] + 1, 2 * nodes[j] + 0, K(2 * i + 1, 2 * j + 0));
+            Triplet trplt22(2 * nodes[i] + 1, 2 * nodes[j] + 1, K(2 * i + 1, 2 * j + 1));
 
             triplets.push_back(trplt11);
             triplets.push_back(trplt12);
@@ -79,6 +79,26 @@ std::vector<Eigen::Triplet<double>> LinearTriangleElement::calculateStiffnessMat
     return triplets;
 }
 
+std::vector<Triplet> LinearTriangleElement::calculateUpperStiffnessMatrix(const Eigen::Matrix3d &D) const
+{
+    Eigen::Matrix<double, 6, 6> K = B.transpose() * D * B * getSquare();
+
+    std::vector<Triplet> triplets;
+    triplets.reserve(21);
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; j < 6; j++)
+        {
+            const Index row = 2 * nodes[i / 2] + i % 2;
+            const Index col = 2 * nodes[j / 2] + j % 2;
+            if (row <= col)
+                triplets.push_back(Triplet(row, col, K(i, j)));
+        }
+    }
+
+    return triplets;
+}
+
 std::vector<double> LinearTriangleElement::calculateStress(const Eigen::VectorX<double> &displacements, const Eigen::Matrix3d &D) const
 {
     Eigen::Matrix<double, 6, 1> delta;
@@ -14,10 +14,16 @@ public:
 
     virtual double getSquare() const;
 
-    virtual std::vector<Eigen::Triplet<double>> calculateStiffnessMatrix(const Eigen::Matrix3d& D) const;
+    virtual std::vector<Triplet> calculateStiffnessMatrix(const Eigen::Matrix3d& D) const;
+
+    /// @brief 21 of 36 entries, the upper triangle in global numbering
+    virtual std::vector<Triplet> calculateUpperStiffnessMatrix(const Eigen::Matrix3d& D) const;
 
     virtual std::vector<double> calculateStress(const Eigen::VectorX<double> & displacements, const Eigen::Matrix3d& D) const;
 
+    /// @brief Strain-displacement matrix, derivatives of shape functions
+    const Eigen::Matrix<double, 3, 6>& getB() const { return B; }
+
     /// @brief Updates B matrix
     /// @details The B matrix is updated right after element construction. Call this method if grid was deformed
     void updateB();
@@ -26,7 +32,7 @@ private:
     Node &node_1;
     Node &node_2;
     Node &node_3;
-    std::vector<int> nodes;
+    std::vector<Index> nodes;
     Eigen::Matrix<double, 3, 6> B; 
 };
 
@@ -0,0 +1,32 @@
+#include "lowRankUpdate.hpp"
+
+#include <limits>
+
+#include "parallel.hpp"
+
+LowRankUpdate::LowRankUpdate(const LinearSolver &_factorization, const Eigen::MatrixX<double> &_U, const Eigen::MatrixX<double> &C)
+    : factorization(_factorization), U(_U)
+{
+    Y.resize(U.rows(), U.cols());
+    parallelFor(0, U.cols(), [this](int begin, int end)
+    {
+        for (int c = begin; c < end; ++c)
+            Y.col(c) = factorization.solve(U.col(c));
+    });
+
+    // Blocks of the capacitance matrix may differ by orders of magnitude, e.g. unit rows of constraints
+    // against stiffness, so it is equilibrated by its diagonal, which is positive for positive definite K
+    const Eigen::MatrixX<double> A = C.inverse() + U.transpose() * Y;
+    scaling = A.diagonal().cwiseAbs().cwiseMax(std::numeric_limits<double>::min()).cwiseSqrt().cwiseInverse();
+    capacitance.compute(Eigen::MatrixX<double>(scaling.asDiagonal() * A * scaling.asDiagonal()));
+    if (!capacitance.isInvertible())
+        throw "Low-rank update is singular";
+}
+
+Eigen::VectorX<double> LowRankUpdate::solve(const Eigen::VectorX<double> &F) const
+{
+    Eigen::VectorX<double> x = factorization.solve(F);
+    if (U.cols() > 0)
+        x -= Y * scaling.cwiseProduct(capacitance.solve(scaling.cwiseProduct(U.transpose() * x)));
+    return x;
+}
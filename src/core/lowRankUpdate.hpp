@@ -0,0 +1,33 @@
+#ifndef LOW_RANK_UPDATE_HPP
+#define LOW_RANK_UPDATE_HPP
+
+#include <Eigen/Dense>
+
+#include "linearSolver.hpp"
+
+/// @brief Solves (K + U * C * U^T) * x = F with an existing factorization of K
+/// @details Sherman-Morrison-Woodbury formula
+///          (K + U C U^T)^-1 = K^-1 - K^-1 U (C^-1 + U^T K^-1 U)^-1 U^T K^-1.
+///          K^-1 U is solved once, columns in parallel, so every following solve costs a single solve
+///          with the factorization and products with n x r matrices, r is the rank of the update.
+class LowRankUpdate
+{
+public:
+    /// @param _factorization factorization of K, must outlive the update
+    /// @param _U n x r basis of the update
+    /// @param C r x r symmetric invertible core of the update
+    LowRankUpdate(const LinearSolver &_factorization, const Eigen::MatrixX<double> &_U, const Eigen::MatrixX<double> &C);
+
+    Eigen::VectorX<double> solve(const Eigen::VectorX<double> &F) const;
+
+    int getRank() const { return U.cols(); }
+
+private:
+    const LinearSolver &factorization;
+    Eigen::MatrixX<double> U;
+    Eigen::MatrixX<double> Y;                               ///< K^-1 * U
+    Eigen::VectorX<double> scaling;                         ///< symmetric diagonal scaling of the capacitance matrix
+    Eigen::FullPivLU<Eigen::MatrixX<double>> capacitance;   ///< scaled C^-1 + U^T * K^-1 * U
+};
+
+#endif /* LOW_RANK_UPDATE_HPP */
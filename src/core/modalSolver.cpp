@@ -0,0 +1,242 @@
+#include "modalSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+#include "linearSolver.hpp"
+#include "parallel.hpp"
+
+/// Subspace is limited to this many vectors per mode, but not less than the minimum (plus two blocks)
+static const int SUBSPACE_FACTOR = 10;
+static const int MIN_SUBSPACE = 64;
+/// Columns reduced below this fraction of their norm by orthogonalization are linearly dependent
+static const double DEFLATION_THRESHOLD = 1.e-10;
+
+ModalSolver::ModalSolver(Solver &_solver, double _density, MassType _massType)
+    : solver(_solver), density(_density), massType(_massType), blockSize(4), iterations(0)
+{
+    calculateMassMatrix();
+}
+
+void ModalSolver::calculateMassMatrix()
+{
+    Geometry &geometry = solver.getGeometry();
+    const int dofsCount = 2 * geometry.getNodes().size();
+
+    std::vector<Triplet> triplets;
+    for (auto element: geometry.getElements())
+    {
+        const double mass = density * element->getSquare();
+        for (int a = 0; a < 3; ++a)
+        {
+            for (int b = 0; b < 3; ++b)
+            {
+                double value = 0.0;
+                if (massType == LUMPED)
+                    value = a == b ? mass / 3.0 : 0.0;
+                else
+                    value = a == b ? mass / 6.0 : mass / 12.0;
+                if (value == 0.0)
+                    continue;
+                for (int d = 0; d < 2; ++d)
+                    triplets.push_back(Triplet(2 * element->getNode(a).id + d, 2 * element->getNode(b).id + d, value));
+            }
+        }
+    }
+
+    M.resize(dofsCount, dofsCount);
+    M.setFromTriplets(triplets.begin(), triplets.end());
+
+    isConstrained.assign(dofsCount, 0);
+    for (Index index: solver.getConstrainedDofs())
+        isConstrained[index] = 1;
+    for (int k = 0; k < M.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(M, k); it; ++it)
+            if (isConstrained[it.row()] || isConstrained[it.col()])
+                it.valueRef() = 0.0;
+    M.prune(0.0);
+
+    // DOFs without mass, e.g. of nodes out of elements, can not vibrate either
+    const Eigen::VectorX<double> diagonal = M.diagonal();
+    for (int i = 0; i < dofsCount; ++i)
+        if (diagonal(i) <= 0.0)
+            isConstrained[i] = 1;
+}
+
+Eigen::MatrixX<double> ModalSolver::orthonormalize(Eigen::MatrixX<double> &X, const Eigen::MatrixX<double> &V, int count) const
+{
+    const int size = X.cols();
+    Eigen::MatrixX<double> coefficients = Eigen::MatrixX<double>::Zero(count + size, size);
+
+    Eigen::VectorX<double> norms(size);
+    for (int c = 0; c < size; ++c)
+        norms(c) = std::sqrt(std::max(0.0, X.col(c).dot(M * X.col(c))));
+
+    // Classical Gram-Schmidt against the basis, repeated once, is as accurate as the modified one
+    for (int pass = 0; pass < 2 && count > 0; ++pass)
+    {
+        const Eigen::MatrixX<double> C = V.leftCols(count).transpose() * (M * X);
+        X -= V.leftCols(count) * C;
+        coefficients.topRows(count) += C;
+    }
+
+    for (int c = 0; c < size; ++c)
+    {
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            const Eigen::VectorX<double> Mx = M * X.col(c);
+            for (int p = 0; p < c; ++p)
+            {
+                const double h = X.col(p).dot(Mx);
+                X.col(c) -= h * X.col(p);
+                coefficients(count + p, c) += h;
+            }
+        }
+
+        const double norm = std::sqrt(std::max(0.0, X.col(c).dot(M * X.col(c))));
+        if (norm > DEFLATION_THRESHOLD * norms(c) && norm > 0.0)
+        {
+            X.col(c) /= norm;
+            coefficients(count + c, c) = norm;
+            continue;
+        }
+
+        // Invariant subspace is found, the basis is continued with a random direction
+        Eigen::VectorX<double> x = Eigen::VectorX<double>::Random(X.rows());
+        for (int i = 0; i < x.size(); ++i)
+            if (isConstrained[i])
+                x(i) = 0.0;
+        const double randomNorm = std::sqrt(x.dot(M * x));
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            if (count > 0)
+                x -= V.leftCols(count) * (V.leftCols(count).transpose() * (M * x));
+            const Eigen::VectorX<double> Mx = M * x;
+            for (int p = 0; p < c; ++p)
+                x -= X.col(p).dot(Mx) * X.col(p);
+        }
+        const double xNorm = std::sqrt(std::max(0.0, x.dot(M * x)));
+        X.col(c) = xNorm > DEFLATION_THRESHOLD * randomNorm ? Eigen::VectorX<double>(x / xNorm) : Eigen::VectorX<double>::Zero(x.size());
+    }
+
+    return coefficients;
+}
+
+void ModalSolver::solve(int modesCount, double shift, double tolerance)
+{
+    const SparseMatrix &K = solver.getMatrix();
+    const int dofsCount = M.rows();
+    if (K.rows() != dofsCount || K.nonZeros() == 0)
+        throw "Stiffness matrix is not calculated";
+
+    const int freeCount = std::count(isConstrained.begin(), isConstrained.end(), 0);
+    if (modesCount <= 0 || modesCount > freeCount)
+        throw "Wrong modes count";
+
+    // One factorization serves all iterations, K keeps the upper triangle only
+    LDLTSolver factorization;
+    factorization.compute(SparseMatrix(K - shift * SparseMatrix(M.triangularView<Eigen::Upper>())));
+
+    const int size = std::max(1, std::min(blockSize, freeCount));
+    const int maxColumns = std::min(freeCount, std::max(SUBSPACE_FACTOR * modesCount, MIN_SUBSPACE) + 2 * size);
+
+    Eigen::MatrixX<double> V(dofsCount, maxColumns + size);
+    Eigen::MatrixX<double> H = Eigen::MatrixX<double>::Zero(maxColumns + size, maxColumns + size);
+
+    Eigen::MatrixX<double> block = Eigen::MatrixX<double>::Random(dofsCount, size);
+    for (int i = 0; i < dofsCount; ++i)
+        if (isConstrained[i])
+            block.row(i).setZero();
+    orthonormalize(block, V, 0);
+    V.leftCols(size) = block;
+    int count = size;
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixX<double>> ritz;
+    std::vector<int> selected(modesCount);
+    iterations = 0;
+    while (true)
+    {
+        ++iterations;
+
+        // W = (K - shift * M)^-1 * M * Q, the columns are solved concurrently
+        const Eigen::MatrixX<double> MQ = M * V.middleCols(count - size, size);
+        parallelFor(0, size, [&](int begin, int end)
+        {
+            for (int c = begin; c < end; ++c)
+                block.col(c) = factorization.solve(MQ.col(c));
+        });
+
+        const Eigen::MatrixX<double> coefficients = orthonormalize(block, V, count);
+        H.block(0, count - size, count + size, size) = coefficients;
+
+        // Rayleigh-Ritz on the projected operator, which is block tridiagonal up to rounding
+        const Eigen::MatrixX<double> T = 0.5 * (H.topLeftCorner(count, count) + H.topLeftCorner(count, count).transpose());
+        ritz.compute(T);
+        const Eigen::VectorX<double> &theta = ritz.eigenvalues();
+
+        // Eigenvalues closest to the shift are the largest in magnitude
+        std::vector<int> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&theta](int lhs, int rhs) { return std::abs(theta(lhs)) > std::abs(theta(rhs)); });
+
+        // Residual of the Ritz pair is R times the last block of its vector, in the M norm
+        const Eigen::MatrixX<double> R = coefficients.bottomRows(size);
+        bool isConverged = count >= modesCount;
+        for (int i = 0; i < modesCount && isConverged; ++i)
+        {
+            const double residual = (R * ritz.eigenvectors().col(order[i]).tail(size)).norm();
+            isConverged = residual <= tolerance * std::abs(theta(order[i]));
+        }
+
+        if (isConverged || count + size > maxColumns)
+        {
+            if (!isConverged && count < freeCount)
+                throw "Eigen solver did not converge";
+            std::copy(order.begin(), order.begin() + modesCount, selected.begin());
+            break;
+        }
+
+        V.middleCols(count, size) = block;
+        count += size;
+    }
+
+    // Back to the original problem, ascending eigenvalues
+    std::vector<double> lambdas(modesCount);
+    for (int i = 0; i < modesCount; ++i)
+        lambdas[i] = shift + 1.0 / ritz.eigenvalues()(selected[i]);
+    std::vector<int> ascending(modesCount);
+    std::iota(ascending.begin(), ascending.end(), 0);
+    std::sort(ascending.begin(), ascending.end(), [&lambdas](int lhs, int rhs) { return lambdas[lhs] < lambdas[rhs]; });
+
+    eigenvalues.resize(modesCount);
+    modes.resize(dofsCount, modesCount);
+    for (int i = 0; i < modesCount; ++i)
+    {
+        eigenvalues(i) = lambdas[ascending[i]];
+        modes.col(i) = V.leftCols(count) * ritz.eigenvectors().col(selected[ascending[i]]);
+        modes.col(i) /= std::sqrt(modes.col(i).dot(M * modes.col(i)));
+    }
+}
+
+Eigen::VectorX<double> ModalSolver::getFrequencies() const
+{
+    return eigenvalues.cwiseMax(0.0).cwiseSqrt() / (2.0 * M_PI);
+}
+
+void ModalSolver::saveMode(const std::string &filename, int mode) const
+{
+    if (mode < 0 || mode >= modes.cols())
+        throw "Wrong mode";
+
+    std::ofstream output;
+    output.open(filename);
+
+    if (!output.is_open())
+        throw "File not found";
+
+    const Index shift = solver.getGeometry().getShift();
+    for (Index i = 0; i < solver.getGeometry().getNodes().size(); ++i)
+        output << i + shift << " " << modes(2 * i + 0, mode) << " " << modes(2 * i + 1, mode) << std::endl;
+}
@@ -0,0 +1,73 @@
+#ifndef MODAL_SOLVER_HPP
+#define MODAL_SOLVER_HPP
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "solver.hpp"
+
+/// @brief Natural vibration modes K * x = lambda * M * x, lambda = omega^2
+/// @details The mass matrix is assembled from the geometry of the solver. K - shift * M is factorized
+///          once and the operator (K - shift * M)^-1 * M, which is self-adjoint in the M inner product,
+///          is applied to blocks of vectors by block Lanczos with full reorthogonalization. Eigenvalues
+///          closest to the shift converge first, so the default zero shift gives the lowest modes.
+///          Constrained DOFs get zero mass and do not take part in the modes.
+class ModalSolver
+{
+public:
+    enum MassType
+    {
+        CONSISTENT,     ///< integrated with linear shape functions, rho * A / 12 * [2 1 1; 1 2 1; 1 1 2]
+        LUMPED          ///< rho * A / 3 at each node
+    };
+
+    /// @param _solver solver with assembled and constrained stiffness matrix, must outlive this one
+    /// @param _density mass per unit volume, unit thickness is assumed as for the stiffness
+    ModalSolver(Solver &_solver, double _density, MassType _massType = CONSISTENT);
+
+    /// @brief Number of vectors in a Lanczos block, solves of a block run in parallel
+    void setBlockSize(int _blockSize) { blockSize = _blockSize; }
+
+    /// @brief Computes the modes with eigenvalues closest to the shift
+    /// @param tolerance relative residual of the shift-inverted problem
+    void solve(int modesCount, double shift = 0.0, double tolerance = 1.e-10);
+
+    /// @brief Mass matrix with zero rows and columns of constrained DOFs
+    const SparseMatrix& getMassMatrix() const { return M; }
+    /// @brief Squared angular frequencies in ascending order
+    const Eigen::VectorX<double>& getEigenvalues() const { return eigenvalues; }
+    /// @brief Frequencies in Hz
+    Eigen::VectorX<double> getFrequencies() const;
+    /// @brief Mass normalized mode shapes as columns
+    const Eigen::MatrixX<double>& getModes() const { return modes; }
+    /// @brief Number of blocks of the last solve
+    int getIterations() const { return iterations; }
+
+    /// @brief Saves the mode shape in the Solver::save format
+    void saveMode(const std::string &filename, int mode) const;
+
+protected:
+    void calculateMassMatrix();
+
+    /// @brief M-orthonormalizes columns of X against the first count columns of V and each other
+    /// @return R of X = X_orthonormal * R, deflated columns are replaced with random vectors and get zero rows
+    Eigen::MatrixX<double> orthonormalize(Eigen::MatrixX<double> &X, const Eigen::MatrixX<double> &V, int count) const;
+
+private:
+    Solver &solver;
+    double density;
+    MassType massType;
+    int blockSize;
+
+    SparseMatrix M;
+    std::vector<char> isConstrained;
+
+    Eigen::VectorX<double> eigenvalues;
+    Eigen::MatrixX<double> modes;
+    int iterations;
+};
+
+#endif /* MODAL_SOLVER_HPP */
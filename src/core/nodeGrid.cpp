@@ -0,0 +1,126 @@
+#include "nodeGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+NodeGrid::NodeGrid() : nodes(nullptr), xMin(0.0), yMin(0.0), cellSize(1.0), columns(0), rows(0) {};
+
+void NodeGrid::build(const std::vector<Node> &_nodes)
+{
+    nodes = &_nodes;
+    cellStart.assign(1, 0);
+    cellNodes.clear();
+    columns = rows = 0;
+    if (_nodes.empty())
+        return;
+
+    xMin = _nodes[0].x;
+    yMin = _nodes[0].y;
+    double xMax = xMin, yMax = yMin;
+    for (auto &node: _nodes)
+    {
+        xMin = std::min(xMin, node.x);
+        xMax = std::max(xMax, node.x);
+        yMin = std::min(yMin, node.y);
+        yMax = std::max(yMax, node.y);
+    }
+
+    // About one node per cell for uniform meshes
+    const double width = xMax - xMin, height = yMax - yMin;
+    cellSize = std::sqrt(std::max(width * height, 1.e-300) / _nodes.size());
+    cellSize = std::max(cellSize, 1.e-12 * std::max(1.0, std::max(width, height)));
+    columns = std::max(1, std::min<int>(_nodes.size(), static_cast<int>(width / cellSize) + 1));
+    rows = std::max(1, std::min<int>(_nodes.size(), static_cast<int>(height / cellSize) + 1));
+    cellSize = std::max(width / columns, height / rows) * (1.0 + 1.e-12);
+    if (cellSize == 0.0)
+        cellSize = 1.0;
+
+    // Counting sort of nodes by cell
+    std::vector<Index> cells(_nodes.size());
+    cellStart.assign(static_cast<Index>(columns) * rows + 1, 0);
+    for (Index i = 0; i < _nodes.size(); ++i)
+    {
+        cells[i] = static_cast<Index>(cellY(_nodes[i].y)) * columns + cellX(_nodes[i].x);
+        ++cellStart[cells[i] + 1];
+    }
+    for (Index c = 0; c < static_cast<Index>(columns) * rows; ++c)
+        cellStart[c + 1] += cellStart[c];
+
+    std::vector<Index> position(cellStart.begin(), cellStart.end() - 1);
+    cellNodes.resize(_nodes.size());
+    for (Index i = 0; i < _nodes.size(); ++i)
+        cellNodes[position[cells[i]]++] = i;
+}
+
+int NodeGrid::cellX(double x) const
+{
+    return std::max(0, std::min(columns - 1, static_cast<int>(std::floor((x - xMin) / cellSize))));
+}
+
+int NodeGrid::cellY(double y) const
+{
+    return std::max(0, std::min(rows - 1, static_cast<int>(std::floor((y - yMin) / cellSize))));
+}
+
+template<class Predicate>
+void NodeGrid::collect(int iy, int ix1, int ix2, Predicate predicate, std::vector<Index> &result) const
+{
+    for (Index c = static_cast<Index>(iy) * columns + ix1; c <= static_cast<Index>(iy) * columns + ix2; ++c)
+        for (Index k = cellStart[c]; k < cellStart[c + 1]; ++k)
+            if (predicate((*nodes)[cellNodes[k]]))
+                result.push_back(cellNodes[k]);
+}
+
+std::vector<Index> NodeGrid::findInBox(double left, double right, double bottom, double top) const
+{
+    std::vector<Index> result;
+    if (columns == 0 || left > right || bottom > top)
+        return result;
+
+    auto inside = [=](const Node &node) { return node.x >= left && node.x <= right && node.y >= bottom && node.y <= top; };
+    const int ix1 = cellX(left), ix2 = cellX(right);
+    for (int iy = cellY(bottom); iy <= cellY(top); ++iy)
+        collect(iy, ix1, ix2, inside, result);
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<Index> NodeGrid::findNearSegment(double x1, double y1, double x2, double y2, double tolerance) const
+{
+    std::vector<Index> result;
+    if (columns == 0)
+        return result;
+
+    const double dx = x2 - x1, dy = y2 - y1;
+    const double length2 = dx * dx + dy * dy;
+    auto near = [=](const Node &node)
+    {
+        double t = length2 > 0.0 ? ((node.x - x1) * dx + (node.y - y1) * dy) / length2 : 0.0;
+        t = std::max(0.0, std::min(1.0, t));
+        const double ex = node.x - x1 - t * dx, ey = node.y - y1 - t * dy;
+        return ex * ex + ey * ey <= tolerance * tolerance;
+    };
+
+    // Every row of cells is visited only where the tolerance band of the segment crosses it,
+    // so long diagonal segments do not scan their whole bounding box
+    const int iy1 = cellY(std::min(y1, y2) - tolerance), iy2 = cellY(std::max(y1, y2) + tolerance);
+    for (int iy = iy1; iy <= iy2; ++iy)
+    {
+        const double bandMin = yMin + iy * cellSize - tolerance, bandMax = bandMin + cellSize + 2.0 * tolerance;
+        double tMin = 0.0, tMax = 1.0;
+        if (dy != 0.0)
+        {
+            const double ta = (bandMin - y1) / dy, tb = (bandMax - y1) / dy;
+            tMin = std::max(tMin, std::min(ta, tb));
+            tMax = std::min(tMax, std::max(ta, tb));
+        }
+        if (tMin > tMax)
+            continue;
+        const double xa = x1 + tMin * dx, xb = x1 + tMax * dx;
+        collect(iy, cellX(std::min(xa, xb) - tolerance), cellX(std::max(xa, xb) + tolerance), near, result);
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
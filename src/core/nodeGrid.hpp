@@ -0,0 +1,48 @@
+#ifndef NODE_GRID_HPP
+#define NODE_GRID_HPP
+
+#include <vector>
+
+#include "element.hpp"
+
+/// @brief Uniform grid spatial index over nodes
+/// @details Bounding box of nodes is split into about one cell per node, nodes of each cell are stored
+///          contiguously (CSR layout). Region queries visit only cells overlapping the region, so a query
+///          costs about the number of found nodes instead of the number of all nodes.
+class NodeGrid
+{
+public:
+    NodeGrid();
+
+    /// @brief Builds the index, nodes must outlive the grid and stay unchanged
+    void build(const std::vector<Node> &nodes);
+
+    /// @brief Nodes inside the box, boundary included
+    /// @return indices in the nodes vector
+    std::vector<Index> findInBox(double left, double right, double bottom, double top) const;
+
+    /// @brief Nodes within tolerance of the segment
+    /// @return indices in the nodes vector
+    std::vector<Index> findNearSegment(double x1, double y1, double x2, double y2, double tolerance) const;
+
+protected:
+    /// @brief Cell index of the coordinate clamped to the grid
+    int cellX(double x) const;
+    int cellY(double y) const;
+
+    /// @brief Appends nodes of cells [ix1, ix2] of row iy satisfying the predicate
+    template<class Predicate>
+    void collect(int iy, int ix1, int ix2, Predicate predicate, std::vector<Index> &result) const;
+
+private:
+    const std::vector<Node> *nodes;
+
+    double xMin, yMin;
+    double cellSize;
+    int columns, rows;
+
+    std::vector<Index> cellStart;   ///< first node of each cell in cellNodes, size is columns * rows + 1
+    std::vector<Index> cellNodes;
+};
+
+#endif /* NODE_GRID_HPP */
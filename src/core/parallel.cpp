@@ -0,0 +1,106 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "threadPool.hpp"
+
+static std::atomic<int> threadsCount(std::max(1u, std::thread::hardware_concurrency()));
+static thread_local int localThreadsCount = 0;
+
+int getThreadsCount()
+{
+    return localThreadsCount > 0 ? localThreadsCount : threadsCount.load();
+}
+
+void setThreadsCount(int count)
+{
+    threadsCount = std::max(1, count);
+}
+
+void setLocalThreadsCount(int count)
+{
+    localThreadsCount = std::max(0, count);
+}
+
+/// @brief Chunks of a loop shared by the calling worker and the helpers queued to its pool
+struct ParallelLoop
+{
+    std::atomic<int> next;
+    int done;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+/// @brief Takes chunks until none is left, the body is not touched once all chunks are taken
+static void runChunks(ParallelLoop &loop, int begin, int count, int chunks, const std::function<void(int, int)> *body)
+{
+    for (int i = loop.next++; i < chunks; i = loop.next++)
+    {
+        std::exception_ptr error;
+        try
+        {
+            (*body)(begin + static_cast<long long>(count) * i / chunks, begin + static_cast<long long>(count) * (i + 1) / chunks);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (error && !loop.error)
+            loop.error = error;
+        if (++loop.done == chunks)
+            loop.finished.notify_all();
+    }
+}
+
+void parallelFor(int begin, int end, const std::function<void(int, int)> &body)
+{
+    const int count = end - begin;
+    if (count <= 0)
+        return;
+
+    const int chunks = std::min(count, getThreadsCount());
+    if (chunks == 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    // Helpers left in the queues after the loop find no chunks and return at once
+    auto loop = std::make_shared<ParallelLoop>();
+    loop->next = 0;
+    loop->done = 0;
+    ThreadPool *pool = ThreadPool::getCurrent();
+    std::vector<std::thread> threads;
+    if (pool)
+    {
+        const auto *bodyPointer = &body;
+        for (int i = 1; i < chunks; ++i)
+            pool->submit([loop, begin, count, chunks, bodyPointer] { runChunks(*loop, begin, count, chunks, bodyPointer); });
+    }
+    else
+    {
+        threads.reserve(chunks - 1);
+        for (int i = 1; i < chunks; ++i)
+            threads.emplace_back(runChunks, std::ref(*loop), begin, count, chunks, &body);
+    }
+
+    runChunks(*loop, begin, count, chunks, &body);
+    for (auto &thread: threads)
+        thread.join();
+    {
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->finished.wait(lock, [&loop, chunks] { return loop->done == chunks; });
+    }
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+}
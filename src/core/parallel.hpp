@@ -0,0 +1,23 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <functional>
+
+/// @brief Number of threads used by parallel algorithms
+/// @details Defaults to the hardware concurrency
+int getThreadsCount();
+void setThreadsCount(int count);
+
+/// @brief Overrides the number of threads for parallel algorithms called from the current thread
+/// @details Zero restores the global count, e.g. batch jobs of small problems run on a single thread
+void setLocalThreadsCount(int count);
+
+/// @brief Runs body over [begin, end) split into contiguous chunks, one chunk per thread
+/// @details On a ThreadPool worker the chunks are queued to the pool instead of new threads: idle
+///          workers steal them, the calling worker takes the ones left, so a busy pool runs the loop
+///          serially without oversubscription. Other callers start threads for the chunks. An exception
+///          of a chunk is rethrown after all chunks, on both paths.
+/// @param body callable receiving chunk bounds [chunkBegin, chunkEnd)
+void parallelFor(int begin, int end, const std::function<void(int, int)> &body);
+
+#endif /* PARALLEL_HPP */
@@ -0,0 +1,182 @@
+#include "server.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+Server::Server(double _poissonRatio, double _youngModulus, Solver::Backend _backend)
+    : poissonRatio(_poissonRatio), youngModulus(_youngModulus), backend(_backend) {};
+
+Solver& Server::getSolver()
+{
+    if (!solver)
+        throw "Mesh is not loaded";
+    return *solver;
+}
+
+void Server::run(std::istream &input, std::ostream &output)
+{
+    std::string request;
+    while (std::getline(input, request))
+    {
+        if (request.empty() || request[0] == '$')
+            continue;
+        if (!handle(request, input, output))
+            break;
+    }
+}
+
+bool Server::handle(const std::string &request, std::istream &input, std::ostream &output)
+{
+    std::istringstream line(request);
+    std::string command;
+    line >> command;
+
+    // Lines of multi-line requests are read even if the request fails, so the stream stays in sync
+    auto readLines = [&input](int count)
+    {
+        std::vector<std::string> lines(count);
+        for (auto &text: lines)
+            if (!std::getline(input, text))
+                throw "Unexpected end of input";
+        return lines;
+    };
+
+    // Results are printed exactly
+    output.precision(std::numeric_limits<double>::max_digits10);
+
+    try
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (command == "QUIT")
+        {
+            output << "OK" << std::endl;
+            return false;
+        }
+        else if (command == "LOAD")
+        {
+            std::string filename;
+            if (!(line >> filename))
+                throw "Mesh file not set";
+
+            std::unique_ptr<Solver> loaded(new Solver(filename, poissonRatio, youngModulus));
+            loaded->setBackend(backend);
+            loaded->setCheckpointDirectory(checkpointDirectory);
+            loaded->calcuateStiffnessMatrix();
+            loaded->applyLoad();
+            loaded->factorize();
+            solver = std::move(loaded);
+
+            output << "OK " << solver->getGeometry().getNodes().size() << " " << solver->getGeometry().getElements().size()
+                   << " " << seconds(start) << std::endl;
+        }
+        else if (command == "MATERIAL")
+        {
+            double poisson, young;
+            if (!(line >> poisson >> young))
+                throw "Wrong material";
+            poissonRatio = poisson;
+            youngModulus = young;
+            if (solver)
+            {
+                if (solver->getBackend() != backend)
+                    solver->setBackend(backend);
+                solver->setMaterial(poisson, young);
+            }
+            output << "OK " << seconds(start) << std::endl;
+        }
+        else if (command == "BACKEND")
+        {
+            std::string name;
+            line >> name;
+            backend = Solver::getBackendByName(name);
+            output << "OK" << std::endl;
+        }
+        else if (command == "LOADCASE")
+        {
+            std::string argument;
+            line >> argument;
+            if (argument == "DEFAULT")
+            {
+                getSolver().applyForces();
+            }
+            else
+            {
+                const int count = std::stoi(argument);
+                const auto lines = readLines(count);
+                Solver &current = getSolver();
+                Eigen::VectorX<double> load = Eigen::VectorX<double>::Zero(current.getLoadVector().size());
+                for (auto &text: lines)
+                {
+                    std::istringstream force(text);
+                    Index id;
+                    int dof;
+                    double value;
+                    if (!(force >> id >> dof >> value) || (dof != 1 && dof != 2))
+                        throw "Wrong nodal force";
+                    load(2 * current.getGeometry().getNode(id).id + dof - 1) += value;
+                }
+                current.setLoadVector(load);
+            }
+            output << "OK" << std::endl;
+        }
+        else if (command == "SOLVE")
+        {
+            Solver &current = getSolver();
+            current.solve();
+            output << "OK " << seconds(start) << " " << current.getDisplacements().cwiseAbs().maxCoeff() << std::endl;
+        }
+        else if (command == "PROBE")
+        {
+            int count = 0;
+            line >> count;
+            const auto lines = readLines(std::max(0, count));
+            std::vector<Eigen::Vector2d> points(lines.size());
+            for (int i = 0; i < lines.size(); ++i)
+            {
+                std::istringstream point(lines[i]);
+                if (!(point >> points[i](0) >> points[i](1)))
+                    throw "Wrong point";
+            }
+
+            auto probes = getSolver().probe(points);
+            std::ostringstream response;
+            response.precision(output.precision());
+            response << "OK " << probes.size() << "\n";
+            for (auto &probe: probes)
+                response << probe.element << " " << probe.ux << " " << probe.uy << " " << probe.sx << " "
+                         << probe.sy << " " << probe.sxy << " " << probe.s << "\n";
+            output << response.str() << std::flush;
+        }
+        else if (command == "SAVE")
+        {
+            std::string result, stress;
+            if (!(line >> result >> stress))
+                throw "File names not set";
+            getSolver().save(result);
+            getSolver().saveSigma(stress);
+            output << "OK" << std::endl;
+        }
+        else
+        {
+            throw "Unknown request";
+        }
+    }
+    catch (const char *message)
+    {
+        output << "ERROR " << message << std::endl;
+    }
+    catch (const std::exception &exception)
+    {
+        output << "ERROR " << exception.what() << std::endl;
+    }
+
+    return true;
+}
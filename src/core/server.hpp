@@ -0,0 +1,52 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "solver.hpp"
+
+/// @brief Resident solver answering requests over text streams, e.g. stdin and stdout
+/// @details Geometry, assembled matrix and its factorization are kept between requests, so load cases,
+///          changes of Young modulus and probes cost about a triangular solve. Requests are lines,
+///          multi-line requests and responses announce the number of following lines:
+///          - LOAD mesh                  assembles and factorizes, responds "OK nodes elements seconds"
+///          - MATERIAL poisson young     responds "OK seconds", see Solver::setMaterial
+///          - BACKEND name               selects linear solver, applied by the next LOAD or MATERIAL, see Solver::getBackendByName
+///          - LOADCASE DEFAULT           restores forces of the mesh boundaries
+///          - LOADCASE n                 followed by n lines "NID DOF SF", replaces forces with nodal ones
+///          - SOLVE                      responds "OK seconds max_displacement"
+///          - PROBE n                    followed by n lines "x y", responds "OK n" and n lines
+///                                       "element ux uy sx sy sxy s", see Solver::probe
+///          - SAVE result stress         saves results as the batch mode does
+///          - QUIT                       stops the server
+///          Failed requests are answered with "ERROR message" and the server keeps running.
+class Server
+{
+public:
+    Server(double _poissonRatio, double _youngModulus, Solver::Backend _backend);
+
+    /// @brief Directory of factorization checkpoints of the meshes loaded next, see Solver::setCheckpointDirectory
+    void setCheckpointDirectory(const std::string &directory) { checkpointDirectory = directory; }
+
+    /// @brief Serves requests until QUIT or the end of input
+    void run(std::istream &input, std::ostream &output);
+
+    /// @brief Handles a single request
+    /// @return false if the server should stop
+    bool handle(const std::string &request, std::istream &input, std::ostream &output);
+
+protected:
+    Solver& getSolver();
+
+private:
+    double poissonRatio;
+    double youngModulus;
+    Solver::Backend backend;
+    std::string checkpointDirectory;
+
+    std::unique_ptr<Solver> solver;
+};
+
+#endif /* SERVER_HPP */
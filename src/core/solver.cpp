@@ -1,45 +1,259 @@
 #include "solver.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <fstream>
 
 #include <Eigen/Sparse>
 #include <Eigen/Dense>
 
+#include "amgSolver.hpp"
+#include "domainDecomposition.hpp"
+#include "parallel.hpp"
+#include "supernodalCholesky.hpp"
 
-Solver::Solver() : poissonRatio(0.3), youngModulus(2000.0) {};
+/// FNV-1a 64-bit offset basis and prime
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+static const uint64_t FNV_PRIME = 1099511628211ull;
+/// Constraint changes of at most this many DOFs update the factorization instead of recomputing it,
+/// the 2 * count solves of the update cost about as much as a refactorization of a 3e5 DOFs plate at 10 DOFs
+static const int MAX_UPDATED_DOFS = 8;
 
-Solver::Solver(double _poissonRatio, double _youngModulus) : poissonRatio(_poissonRatio), youngModulus(_youngModulus) {};
+static void hashBytes(uint64_t &hash, const void *data, size_t bytes)
+{
+    const unsigned char *begin = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        hash ^= begin[i];
+        hash *= FNV_PRIME;
+    }
+}
+
+Solver::Solver() : poissonRatio(0.3), youngModulus(2000.0), backend(LDLT), isFactorized(false), solutionScale(1.0), isFromCheckpoint(false) {};
+
+Solver::Solver(double _poissonRatio, double _youngModulus) : poissonRatio(_poissonRatio), youngModulus(_youngModulus), backend(LDLT), isFactorized(false), solutionScale(1.0), isFromCheckpoint(false) {};
 
-Solver::Solver(const std::string & filename) : poissonRatio(0.3), youngModulus(2000.0)
+Solver::Solver(const std::string & filename) : poissonRatio(0.3), youngModulus(2000.0), backend(LDLT), isFactorized(false), solutionScale(1.0), isFromCheckpoint(false)
 {
     loadGeometry(filename);
 };
 
-Solver::Solver(const std::string & filename, double _poissonRatio, double _youngModulus) : poissonRatio(_poissonRatio), youngModulus(_youngModulus)
+Solver::Solver(const std::string & filename, double _poissonRatio, double _youngModulus) : poissonRatio(_poissonRatio), youngModulus(_youngModulus), backend(LDLT), isFactorized(false), solutionScale(1.0), isFromCheckpoint(false)
 {
     loadGeometry(filename);
 };
 
+void Solver::setBackend(Backend _backend)
+{
+    backend = _backend;
+    constraintUpdate.reset();
+    linearSolver.reset();
+}
+
+Solver::Backend Solver::getBackendByName(const std::string &name)
+{
+    if (name == "ldlt")
+        return LDLT;
+    if (name == "dd")
+        return DOMAIN_DECOMPOSITION;
+    if (name == "supernodal")
+        return SUPERNODAL;
+    if (name == "amg")
+        return AMG;
+    throw "Unknown backend";
+}
+
+std::unique_ptr<LinearSolver> Solver::createLinearSolver()
+{
+    switch (backend)
+    {
+    case DOMAIN_DECOMPOSITION:
+        // A few subdomains per thread keep threads busy when subdomains are uneven
+        return std::unique_ptr<LinearSolver>(new DomainDecompositionSolver(geometry, std::max(2, 2 * getThreadsCount())));
+    case SUPERNODAL:
+        return std::unique_ptr<LinearSolver>(new SupernodalCholesky());
+    case AMG:
+        return std::unique_ptr<LinearSolver>(new AmgSolver(geometry));
+    case LDLT:
+    default:
+        return std::unique_ptr<LinearSolver>(new LDLTSolver());
+    }
+}
+
+uint64_t Solver::getCheckpointKey()
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    const std::vector<Node> &nodes = geometry.getNodes();
+    const uint64_t nodesCount = nodes.size();
+    hashBytes(hash, &nodesCount, sizeof(nodesCount));
+    for (const Node &node: nodes)
+    {
+        hashBytes(hash, &node.x, sizeof(node.x));
+        hashBytes(hash, &node.y, sizeof(node.y));
+    }
+
+    const std::vector<Index> connectivity = geometry.getConnectivity();
+    const uint64_t elementsCount = connectivity.size() / 3;
+    hashBytes(hash, &elementsCount, sizeof(elementsCount));
+    hashBytes(hash, connectivity.data(), sizeof(Index) * connectivity.size());
+
+    hashBytes(hash, &poissonRatio, sizeof(poissonRatio));
+    hashBytes(hash, &youngModulus, sizeof(youngModulus));
+
+    // The same DOF may be constrained by several boundaries
+    std::vector<Index> constrained = getConstrainedDofs();
+    std::sort(constrained.begin(), constrained.end());
+    constrained.erase(std::unique(constrained.begin(), constrained.end()), constrained.end());
+    hashBytes(hash, constrained.data(), sizeof(Index) * constrained.size());
+
+    return hash;
+}
+
+std::string Solver::getCheckpointFilename()
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.chol", static_cast<unsigned long long>(getCheckpointKey()));
+    return checkpointDirectory + "/" + name;
+}
+
+bool Solver::loadCheckpoint()
+{
+    if (checkpointDirectory.empty() || backend != SUPERNODAL || globalK.nonZeros() == 0)
+        return false;
+
+    std::unique_ptr<SupernodalCholesky> cholesky(new SupernodalCholesky());
+    if (!cholesky->load(getCheckpointFilename(), getCheckpointKey()))
+        return false;
+
+    constraintUpdate.reset();
+    linearSolver = std::move(cholesky);
+    factorizedConstraints = appliedConstraints;
+    isFactorized = true;
+    isFromCheckpoint = true;
+    solutionScale = 1.0;
+    return true;
+}
+
+void Solver::analyzePattern()
+{
+    if (loadCheckpoint())
+        return;
+
+    constraintUpdate.reset();
+    linearSolver = createLinearSolver();
+    linearSolver->analyzePattern(globalK);
+    isFactorized = false;
+    isFromCheckpoint = false;
+}
+
+void Solver::factorize()
+{
+    if (!linearSolver)
+        analyzePattern();
+    if (isFactorized && isFromCheckpoint)
+        return;
+
+    constraintUpdate.reset();
+    linearSolver->factorize(globalK);
+    factorizedConstraints = appliedConstraints;
+    isFactorized = true;
+    isFromCheckpoint = false;
+    solutionScale = 1.0;
+
+    if (!checkpointDirectory.empty() && backend == SUPERNODAL)
+        static_cast<SupernodalCholesky &>(*linearSolver).save(getCheckpointFilename(), getCheckpointKey());
+}
+
 void Solver::solve() 
 {
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > solver(globalK);
+    if (!linearSolver || !isFactorized)
+        factorize();
 
-	displacements = solver.solve(F);
+    if (constraintUpdate)
+    {
+        // Unit rows of constraints are far from the stiffness scale, so the update cancels digits,
+        // one step of iterative refinement with the updated matrix restores them. The matrix may be scaled
+        // since the factorization, see setMaterial
+        displacements = constraintUpdate->solve(F);
+        Eigen::VectorX<double> product = globalK.selfadjointView<Eigen::Upper>() * displacements;
+        displacements += constraintUpdate->solve(F - solutionScale * product);
+    }
+    else
+    {
+        displacements = linearSolver->solve(F);
+    }
+    if (solutionScale != 1.0)
+        displacements *= solutionScale;
 };
 
 void Solver::loadGeometry(const std::string & filename)
 {
     geometry.loadFromFile(filename);
+    prepare();
+}
+
+void Solver::refine(const std::vector<int> &markedElements)
+{
+    geometry.refine(markedElements);
+    prepare();
+}
 
+void Solver::prepare()
+{
     // Prepare matrix and vector
-    const int nodesCount = geometry.getNodes().size();
+    const Index nodesCount = geometry.getNodes().size();
     globalK.resize(2 * nodesCount, 2 * nodesCount);
     this->F.resize(2 * nodesCount);
     F.setZero();
+    constraintUpdate.reset();
+    linearSolver.reset();
+    appliedConstraints.clear();
+    bvh.reset();
 }
 
-void Solver::calcuateStiffnessMatrix()
+void Solver::setMaterial(double _poissonRatio, double _youngModulus)
+{
+    if (_poissonRatio == poissonRatio && _youngModulus == youngModulus)
+        return;
+
+    const bool isAssembled = globalK.nonZeros() > 0;
+    if (isAssembled && _poissonRatio == poissonRatio)
+    {
+        // Stiffness is proportional to Young modulus, unit rows of constraints are kept
+        const double ratio = _youngModulus / youngModulus;
+        youngModulus = _youngModulus;
+        globalK *= ratio;
+        for (Index index : appliedConstraints)
+            globalK.coeffRef(index, index) = 1.0;
+        solutionScale /= ratio;
+        return;
+    }
+
+    poissonRatio = _poissonRatio;
+    youngModulus = _youngModulus;
+    if (isAssembled)
+    {
+        calcuateStiffnessMatrix();
+        applyConstraints();
+    }
+}
+
+void Solver::setLoadVector(const Eigen::VectorX<double> &load)
+{
+    if (load.size() != F.size())
+        throw "Wrong load vector size";
+    F = load;
+    for (Index index : getConstrainedDofs())
+        F(index) = 0.0;
+}
+
+Eigen::Matrix3d Solver::getElasticityMatrix() const
 {
 	Eigen::Matrix3d D;
 	D << 1.0,        	poissonRatio,	0.0,
@@ -48,16 +262,28 @@ void Solver::calcuateStiffnessMatrix()
 
     D *= youngModulus / (1.0f - pow(poissonRatio, 2.0f));
 
+    return D;
+}
+
+void Solver::calcuateStiffnessMatrix()
+{
+    const Eigen::Matrix3d D = getElasticityMatrix();
+
     auto elements = geometry.getElements();
-    std::vector<Eigen::Triplet<double>> globalTriplets;
+    // Only the upper triangle is stored, all backends read it
+    std::vector<Triplet> globalTriplets;
+    globalTriplets.reserve(21 * elements.size());
     for (auto element: elements)
     {
-        auto localTriplets = element->calculateStiffnessMatrix(D);
+        auto localTriplets = element->calculateUpperStiffnessMatrix(D);
         // This is bad solution, but unfortunately the sparse matrix must be set in single call
         globalTriplets.insert(globalTriplets.end(), localTriplets.begin(), localTriplets.end());
     }
 
     globalK.setFromTriplets(globalTriplets.begin(), globalTriplets.end());
+    constraintUpdate.reset();
+    linearSolver.reset();
+    appliedConstraints.clear();
 
 
     // Desirable, but unsupported solution
@@ -69,51 +295,240 @@ void Solver::calcuateStiffnessMatrix()
 
 };
 
-void Solver::applyLoad()
+std::vector<Index> Solver::getConstrainedDofs()
 {
-    std::vector<int> indicesToConstraint;
-
-    auto boundaries = geometry.getBoundaries();
-
-    for (auto boundary : boundaries)
+    std::vector<Index> indicesToConstraint;
+    for (auto &boundary : geometry.getBoundaries())
     {
         for (auto it = boundary.nodes.begin(); it!=boundary.nodes.end(); ++it)
         {
-            if (it->type == BoundaryNode::UX)
+            if (it->type == BoundaryNode::UX || it->type == BoundaryNode::UXY)
             {
                 indicesToConstraint.push_back(2 * it->node + 0);
             }
-            if (it->type == BoundaryNode::UY)
+            if (it->type == BoundaryNode::UY || it->type == BoundaryNode::UXY)
             {
                 indicesToConstraint.push_back(2 * it->node + 1);
             }
         }
     }
+    return indicesToConstraint;
+}
 
-    std::vector<Node> & nodes = geometry.getNodes();
-    const auto &f_boundary = boundaries[2].nodes;
-    for (int i=0; i<f_boundary.size()-1; ++i)
+void Solver::applyLoad()
+{
+    applyConstraints();
+    applyForces();
+};
+
+void Solver::applyConstraints()
+{
+    std::vector<Index> constrained = getConstrainedDofs();
+    std::sort(constrained.begin(), constrained.end());
+    constrained.erase(std::unique(constrained.begin(), constrained.end()), constrained.end());
+
+    std::vector<char> isConstrained(globalK.rows(), 0);
+    for (Index index : constrained)
+        isConstrained[index] = 1;
+
+    // Released DOFs get their stiffness back, the symmetric entries of the upper triangle too
+    std::vector<Index> released;
+    std::set_difference(appliedConstraints.begin(), appliedConstraints.end(), constrained.begin(), constrained.end(),
+                        std::back_inserter(released));
+    if (!released.empty())
     {
-        double l = geometry.getNode(f_boundary[i+1].node + geometry.getShift()).y - geometry.getNode(f_boundary[i].node + geometry.getShift()).y;
-        double f = 1000000.0 * l;
-        F(2 * f_boundary[i].node + 0)   += 0.5 * f;
-        F(2 * f_boundary[i+1].node + 0) += 0.5 * f;
+        restoreStiffness(released);
     }
 
-	for (int k = 0; k < globalK.outerSize(); ++k)
+	for (Index k = 0; k < globalK.outerSize(); ++k)
 	{
-		for (Eigen::SparseMatrix<double>::InnerIterator it(globalK, k); it; ++it)
+		for (SparseMatrix::InnerIterator it(globalK, k); it; ++it)
 		{
-			for (std::vector<int>::iterator idit = indicesToConstraint.begin(); idit != indicesToConstraint.end(); ++idit)
-			{
-                if (it.row() == *idit || it.col() == *idit)
-                {
-                    it.valueRef() = it.row() == it.col() ? 1.0 : 0.0;
-                }
-			}
+            if (isConstrained[it.row()] || isConstrained[it.col()])
+            {
+                it.valueRef() = it.row() == it.col() ? 1.0 : 0.0;
+            }
 		}
 	}
-};
+    appliedConstraints.swap(constrained);
+
+    // Pattern is kept, so is the symbolic analysis
+    if (!updateFactorization())
+        isFactorized = false;
+}
+
+void Solver::restoreStiffness(const std::vector<Index> &dofs)
+{
+    const Eigen::Matrix3d D = getElasticityMatrix();
+
+    std::vector<char> isRestored(globalK.rows(), 0);
+    for (Index index : dofs)
+        isRestored[index] = 1;
+
+    for (Index k = 0; k < globalK.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(globalK, k); it; ++it)
+            if (isRestored[it.row()] || isRestored[it.col()])
+                it.valueRef() = 0.0;
+
+    // Entries of the elements exist in the pattern, so they are added without insertions
+    for (auto element: geometry.getElements())
+    {
+        bool isAdjacent = false;
+        for (int i = 0; i < 3 && !isAdjacent; ++i)
+            isAdjacent = isRestored[2 * element->getNode(i).id + 0] || isRestored[2 * element->getNode(i).id + 1];
+        if (!isAdjacent)
+            continue;
+
+        for (auto &triplet: element->calculateUpperStiffnessMatrix(D))
+            if (isRestored[triplet.row()] || isRestored[triplet.col()])
+                globalK.coeffRef(triplet.row(), triplet.col()) += triplet.value();
+    }
+}
+
+Eigen::MatrixX<double> Solver::calculateStiffnessColumns(const std::vector<Index> &dofs)
+{
+    const Eigen::Matrix3d D = getElasticityMatrix();
+
+    std::vector<int> position(globalK.rows(), -1);
+    for (int i = 0; i < dofs.size(); ++i)
+        position[dofs[i]] = i;
+
+    Eigen::MatrixX<double> columns = Eigen::MatrixX<double>::Zero(globalK.rows(), dofs.size());
+    for (auto element: geometry.getElements())
+    {
+        bool isAdjacent = false;
+        for (int i = 0; i < 3 && !isAdjacent; ++i)
+            isAdjacent = position[2 * element->getNode(i).id + 0] != -1 || position[2 * element->getNode(i).id + 1] != -1;
+        if (!isAdjacent)
+            continue;
+
+        for (auto &triplet: element->calculateStiffnessMatrix(D))
+            if (position[triplet.col()] != -1)
+                columns(triplet.row(), position[triplet.col()]) += triplet.value();
+    }
+    return columns;
+}
+
+bool Solver::updateFactorization()
+{
+    constraintUpdate.reset();
+    // A scaled matrix (see setMaterial) is not the factorized one, AMG hierarchy is not exact
+    if (!linearSolver || !isFactorized || backend == AMG || solutionScale != 1.0)
+        return false;
+
+    std::vector<Index> changed;
+    std::set_symmetric_difference(factorizedConstraints.begin(), factorizedConstraints.end(),
+                                  appliedConstraints.begin(), appliedConstraints.end(), std::back_inserter(changed));
+    if (changed.empty())
+        return true;
+    if (changed.size() > MAX_UPDATED_DOFS)
+        return false;
+
+    const Index n = globalK.rows();
+    const int m = changed.size();
+    std::vector<char> wasConstrained(n, 0), isConstrained(n, 0);
+    for (Index index : factorizedConstraints)
+        wasConstrained[index] = 1;
+    for (Index index : appliedConstraints)
+        isConstrained[index] = 1;
+
+    // Only rows and columns of the changed DOFs differ: E = K - K0 = Z * G^T + G * Z^T,
+    // Z are unit columns of the DOFs and G = E * Z - Z * (Z^T * E * Z) / 2
+    const Eigen::MatrixX<double> columns = calculateStiffnessColumns(changed);
+    auto constrain = [&columns, &changed](const std::vector<char> &isFixed, int c)
+    {
+        Eigen::VectorX<double> column = columns.col(c);
+        if (isFixed[changed[c]])
+            column.setZero();
+        for (Index i = 0; i < column.size(); ++i)
+            if (isFixed[i])
+                column(i) = i == changed[c] ? 1.0 : 0.0;
+        return column;
+    };
+
+    Eigen::MatrixX<double> G(n, m);
+    for (int c = 0; c < m; ++c)
+        G.col(c) = constrain(isConstrained, c) - constrain(wasConstrained, c);
+    Eigen::MatrixX<double> Ess(m, m);
+    for (int i = 0; i < m; ++i)
+        Ess.row(i) = G.row(changed[i]);
+    for (int i = 0; i < m; ++i)
+        G.row(changed[i]) -= 0.5 * Ess.row(i);
+
+    // Columns of G are normalized, so the capacitance matrix is well scaled: U = [Z, G / s], C = [0, S; S, 0]
+    Eigen::MatrixX<double> U = Eigen::MatrixX<double>::Zero(n, 2 * m);
+    Eigen::MatrixX<double> C = Eigen::MatrixX<double>::Zero(2 * m, 2 * m);
+    for (int c = 0; c < m; ++c)
+    {
+        const double scale = G.col(c).norm();
+        if (scale == 0.0)
+            return false;
+        U(changed[c], c) = 1.0;
+        U.col(m + c) = G.col(c) / scale;
+        C(c, m + c) = scale;
+        C(m + c, c) = scale;
+    }
+
+    try
+    {
+        constraintUpdate.reset(new LowRankUpdate(*linearSolver, U, C));
+    }
+    catch (const char *)
+    {
+        return false;
+    }
+    return true;
+}
+
+void Solver::applyForces()
+{
+    F.setZero();
+
+    std::vector<std::array<Index, 2>> edges;
+    for (auto &boundary : geometry.getBoundaries())
+    {
+        if (boundary.fx == 0.0 && boundary.fy == 0.0)
+            continue;
+
+        if (!boundary.distributed)
+        {
+            for (auto &node : boundary.nodes)
+            {
+                if (node.type != BoundaryNode::F)
+                    continue;
+                F(2 * node.node + 0) += boundary.fx;
+                F(2 * node.node + 1) += boundary.fy;
+            }
+            continue;
+        }
+
+        // Traction is integrated over boundary edges with both nodes loaded, half of the edge force per node
+        if (edges.empty())
+            edges = geometry.getBoundaryEdges();
+        std::vector<char> isLoaded(F.size() / 2, 0);
+        for (auto &node : boundary.nodes)
+            if (node.type == BoundaryNode::F)
+                isLoaded[node.node] = 1;
+
+        for (auto &edge : edges)
+        {
+            if (!isLoaded[edge[0]] || !isLoaded[edge[1]])
+                continue;
+            const Node &a = geometry.getNode(edge[0] + geometry.getShift());
+            const Node &b = geometry.getNode(edge[1] + geometry.getShift());
+            const double l = std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+            for (Index node : edge)
+            {
+                F(2 * node + 0) += 0.5 * boundary.fx * l;
+                F(2 * node + 1) += 0.5 * boundary.fy * l;
+            }
+        }
+    }
+
+    // Constrained DOFs have unit rows, so zero right hand side keeps them fixed
+    for (Index index : getConstrainedDofs())
+        F(index) = 0.0;
+}
 
 void Solver::save(const std::string & filename)
 {
@@ -123,9 +538,9 @@ void Solver::save(const std::string & filename)
     if (!output.is_open())
         throw "File not found";
 
-    const int shift = geometry.getShift();
+    const Index shift = geometry.getShift();
 
-    for (int i = 0; i < geometry.getNodes().size(); ++i)
+    for (Index i = 0; i < geometry.getNodes().size(); ++i)
     {
         output << i + shift << " " << displacements[2*i+0] << " " << displacements[2*i+1] << std::endl;
     }
@@ -134,6 +549,11 @@ void Solver::save(const std::string & filename)
 }
 
 void Solver::saveSigma(const std::string & filename)
+{
+    saveSigma(filename, calculateStress());
+}
+
+void Solver::saveSigma(const std::string & filename, const std::vector<std::vector<double>> & sigmas)
 {
     std::ofstream output;
     output.open(filename);
@@ -141,8 +561,6 @@ void Solver::saveSigma(const std::string & filename)
     if (!output.is_open())
         throw "File not found";
 
-    auto sigmas = calculateStress();
-
     output << "Sx\tSy\tSxy\tS" << std::endl;
     for (int i = 0; i < sigmas.size(); ++i)
     {
@@ -153,26 +571,129 @@ void Solver::saveSigma(const std::string & filename)
 
 std::vector<std::vector<double>> Solver::calculateStress()
 {
-    Eigen::Matrix3d D;
-	D << 1.0,        	poissonRatio,	0.0,
-         poissonRatio,	1.0,         	0.0,
-         0.0,        	0.0,        	(1.0 - poissonRatio) / 2.0;
-
-    D *= youngModulus / (1.0f - pow(poissonRatio, 2.0f));
+    const Eigen::Matrix3d D = getElasticityMatrix();
 
     auto elements = geometry.getElements();
 
     std::vector<std::vector<double>> result(elements.size());
 
 
-    for (int i=0; i<elements.size(); ++i)
+    parallelFor(0, elements.size(), [&](int begin, int end)
+    {
+        for (int i=begin; i<end; ++i)
+        {
+            result[i] = calculateElementStress(i, D);
+        }
+    });
+
+    return result;
+}
+
+void Solver::calculateStress(Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor> &stress)
+{
+    const Eigen::Matrix3d D = getElasticityMatrix();
+
+    stress.resize(geometry.getElements().size(), 4);
+    parallelFor(0, stress.rows(), [&](int begin, int end)
+    {
+        for (int i=begin; i<end; ++i)
+        {
+            const std::vector<double> sigma = calculateElementStress(i, D);
+            stress.row(i) << sigma[0], sigma[1], sigma[2], sigma[3];
+        }
+    });
+}
+
+std::vector<double> Solver::calculateElementStress(int element, const Eigen::Matrix3d &D)
+{
+    std::vector<double> sigma = geometry.getElements()[element]->calculateStress(displacements, D);
+    double sigma_mises = sqrt(sigma[0] * sigma[0] - sigma[0] * sigma[1] + sigma[1] * sigma[1] + 3.0f * sigma[2] * sigma[2]);
+    sigma.push_back(sigma_mises);
+    return sigma;
+}
+
+std::vector<ProbeResult> Solver::probe(const std::vector<Eigen::Vector2d> &points)
+{
+    if (displacements.size() != 2 * geometry.getNodes().size())
+        throw "Results are not calculated";
+
+    if (!bvh)
     {
-        std::vector<double> sigma = elements[i]->calculateStress(displacements, D);
-        double sigma_mises = sqrt(sigma[0] * sigma[0] - sigma[0] * sigma[1] + sigma[1] * sigma[1] + 3.0f * sigma[2] * sigma[2]);
-        sigma.push_back(sigma_mises);
-        result[i] = sigma;
+        bvh.reset(new TriangleBvh());
+        bvh->build(geometry.getElements());
     }
 
+    const Eigen::Matrix3d D = getElasticityMatrix();
+    auto &elements = geometry.getElements();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    // Points are bucketed in Morton order of a 256 x 256 grid, so consecutive queries walk the same
+    // branches of the hierarchy and hit the same elements, which keeps them in cache for large batches
+    const int bits = 8;
+    Eigen::Vector2d lower = Eigen::Vector2d::Constant(std::numeric_limits<double>::max());
+    Eigen::Vector2d upper = -lower;
+    for (auto &point: points)
+    {
+        lower = lower.cwiseMin(point);
+        upper = upper.cwiseMax(point);
+    }
+    const Eigen::Vector2d scale = (upper - lower).cwiseMax(1.e-300).cwiseInverse() * ((1 << bits) - 1);
+    std::vector<int> codes(points.size());
+    std::vector<int> bucketStart((1 << 2 * bits) + 1, 0);
+    for (int i = 0; i < points.size(); ++i)
+    {
+        const int x = std::max(0.0, (points[i](0) - lower(0)) * scale(0));
+        const int y = std::max(0.0, (points[i](1) - lower(1)) * scale(1));
+        int code = 0;
+        for (int bit = 0; bit < bits; ++bit)
+            code |= (((x >> bit) & 1) << (2 * bit)) | (((y >> bit) & 1) << (2 * bit + 1));
+        codes[i] = code;
+        ++bucketStart[code + 1];
+    }
+    for (int b = 0; b < (1 << 2 * bits); ++b)
+        bucketStart[b + 1] += bucketStart[b];
+    std::vector<int> order(points.size());
+    for (int i = 0; i < points.size(); ++i)
+        order[bucketStart[codes[i]]++] = i;
+
+    std::vector<ProbeResult> result(points.size());
+    parallelFor(0, points.size(), [&](int begin, int end)
+    {
+        double weights[3];
+        // Neighbouring points often share the element, its stress is computed once
+        int lastElement = -1;
+        std::vector<double> sigma;
+        for (int k = begin; k < end; ++k)
+        {
+            const int i = order[k];
+            ProbeResult &probe = result[i];
+            probe.element = bvh->find(points[i](0), points[i](1), weights);
+            if (probe.element == -1)
+            {
+                probe.ux = probe.uy = probe.sx = probe.sy = probe.sxy = probe.s = nan;
+                continue;
+            }
+
+            const Element &element = *elements[probe.element];
+            probe.ux = probe.uy = 0.0;
+            for (int j = 0; j < 3; ++j)
+            {
+                probe.ux += weights[j] * displacements(2 * element.getNode(j).id + 0);
+                probe.uy += weights[j] * displacements(2 * element.getNode(j).id + 1);
+            }
+
+            if (probe.element != lastElement)
+            {
+                sigma = calculateElementStress(probe.element, D);
+                lastElement = probe.element;
+            }
+            probe.sx = sigma[0];
+            probe.sy = sigma[1];
+            probe.sxy = sigma[2];
+            probe.s = sigma[3];
+        }
+    });
+
     return result;
 }
 
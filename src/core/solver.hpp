@@ -1,13 +1,41 @@
 #ifndef SOLVER_HPP
 #define SOLVER_HPP
 
+#include <cstdint>
+#include <memory>
+#include <string>
+
 #include <Eigen/Sparse>
 
 #include "geometry.hpp"
+#include "linearSolver.hpp"
+#include "lowRankUpdate.hpp"
+#include "triangleBvh.hpp"
+
+/// @brief Results interpolated at a point, see Solver::probe
+struct ProbeResult
+{
+    int element;        ///< element containing the point, -1 if the point is out of the mesh and values are NaN
+    double ux;
+    double uy;
+    double sx;          ///< stresses are constant over linear triangles
+    double sy;
+    double sxy;
+    double s;           ///< von Mises stress
+};
 
 class Solver
 {
 public:
+    /// @brief Linear system solver backends
+    enum Backend
+    {
+        LDLT,                   ///< Eigen simplicial LDL^T
+        DOMAIN_DECOMPOSITION,   ///< Thread-parallel substructuring, see DomainDecompositionSolver
+        SUPERNODAL,             ///< Multithreaded supernodal Cholesky, see SupernodalCholesky
+        AMG                     ///< Conjugate gradients with algebraic multigrid, see AmgSolver
+    };
+
     Solver();
     Solver(double _poissonRatio, double youngModulus);
     Solver(const std::string & filename);
@@ -18,46 +46,150 @@ public:
     /// @param filename file with mesh
     void loadGeometry(const std::string & filename);
 
+    /// @brief Refines marked elements of the geometry
+    /// @details Matrix, load vector and factorization are dropped, so they should be calculated again
+    /// @param markedElements indices of elements to refine, see Geometry::refine
+    void refine(const std::vector<int> &markedElements);
+
+    /// @brief Changes material
+    /// @details Assembled matrix is updated. If only Young modulus is changed, the matrix is scaled and the
+    ///          existing factorization is reused, since the stiffness is proportional to it.
+    void setMaterial(double _poissonRatio, double _youngModulus);
+
+    /// @brief Replaces load vector, e.g. with another load case
+    /// @details Constrained DOFs are nullified, the factorization is kept
+    void setLoadVector(const Eigen::VectorX<double> &load);
+
+    /// @brief Selects linear system solver
+    /// @details Drops existing factorization
+    void setBackend(Backend _backend);
+    Backend getBackend() const { return backend; }
+    /// @brief Backend by its command line name: ldlt, dd, supernodal or amg
+    static Backend getBackendByName(const std::string &name);
+
+    /// @brief Directory of factorization checkpoints, empty string disables them
+    /// @details Used by the supernodal backend only: analyzePattern loads the checkpoint of the current
+    ///          key if it exists, so neither analysis nor factorization is needed, and factorize saves
+    ///          a checkpoint otherwise. The directory must exist.
+    void setCheckpointDirectory(const std::string &directory) { checkpointDirectory = directory; }
+    /// @brief FNV-1a hash of node coordinates, connectivity, material and constrained DOFs
+    uint64_t getCheckpointKey();
+    /// @brief Checkpoint file of the current key in the checkpoint directory
+    std::string getCheckpointFilename();
+    /// @brief True if the current factorization was loaded from a checkpoint
+    bool isCheckpointLoaded() const { return isFromCheckpoint; }
+    /// @brief Rank of the low-rank update of the factorization by changed constraints, 0 if there is none
+    int getUpdateRank() const { return constraintUpdate ? constraintUpdate->getRank() : 0; }
+
+    /// @brief Symbolic analysis of the global matrix with the selected backend
+    /// @details Depends only on the matrix pattern, so it is kept when constraints change values
+    void analyzePattern();
+
+    /// @brief Factorizes the global matrix with the selected backend
+    /// @details Called by Solver::solve if matrix was changed since the last factorization,
+    ///          analyzes the pattern first if needed. Does nothing for a loaded checkpoint which is
+    ///          still up to date.
+    void factorize();
+
     /// @brief Solves the equations
     void solve();
 
     /// @brief Calculates striffness matrix
     void calcuateStiffnessMatrix();
     /// @brief Applies loads
-    /// @details Applies external forces and boundary contitions to vector and matrix.
-    ///          External force values goes to load vector, boundary condition goes both to
-    ///          vector, nullifying it, and matrix, nullifying all element in row and column except diagonal.
-    /// @todo should split into two methods
+    /// @details Applies external forces and boundary contitions to vector and matrix,
+    ///          see applyConstraints and applyForces.
     void applyLoad();
+    /// @brief Applies boundary conditions to matrix, nullifying all element in row and column except diagonal
+    /// @details Constraints of the geometry boundaries may change between calls: stiffness of released DOFs
+    ///          is restored from their elements. If a few DOFs differ from the constraints of the existing
+    ///          factorization, it is kept and the change is solved as a low-rank update, see LowRankUpdate.
+    void applyConstraints();
+    /// @brief Fills load vector with external forces of boundaries, constrained DOFs are nullified
+    void applyForces();
 
     /// @brief Save results
     /// @{
     void save(const std::string &filename);
     void saveSigma(const std::string & filename);
+    /// @brief Saves already calculated stresses, see calculateStress
+    void saveSigma(const std::string & filename, const std::vector<std::vector<double>> & sigmas);
     /// @}
 
     /// @brief Calculates stress
     /// @return stresses for each element
     std::vector<std::vector<double>> calculateStress();
+    /// @brief Sx, Sy, Sxy and von Mises stress of elements as rows of a contiguous matrix
+    void calculateStress(Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor> &stress);
+
+    /// @brief Displacements and stresses at arbitrary points
+    /// @details Points are located with a bounding volume hierarchy over elements, built by the first call
+    ///          after the geometry is changed. Displacements are interpolated with shape functions.
+    ///          Points are processed by getThreadsCount() threads.
+    std::vector<ProbeResult> probe(const std::vector<Eigen::Vector2d> &points);
 
     /// @brief Getter for global matrix
-    /// @return global sparse matrix
-    const Eigen::SparseMatrix<double>& getMatrix() { return globalK; };
+    /// @return upper triangle of global sparse matrix, use selfadjointView<Eigen::Upper>() for products
+    const SparseMatrix& getMatrix() { return globalK; };
     /// @brief Getter for load vector
     /// @return global load vector
     const Eigen::VectorX<double>& getLoadVector() { return F; };
     const Eigen::VectorX<double>& getDisplacements() { return displacements; };
+    Geometry& getGeometry() { return geometry; };
+
+    /// @brief DOFs fixed by boundary conditions
+    std::vector<Index> getConstrainedDofs();
+
+    /// @brief Plane stress elasticity matrix of the material
+    Eigen::Matrix3d getElasticityMatrix() const;
+    double getPoissonRatio() const { return poissonRatio; }
+    double getYoungModulus() const { return youngModulus; }
 protected:
     // void calculateStress();
+
+    /// @brief Resizes matrix and vector to the geometry
+    void prepare();
+
+    std::unique_ptr<LinearSolver> createLinearSolver();
+
+    /// @brief Replaces the linear solver with the checkpoint of the current key
+    /// @return false if checkpoints are disabled or not found
+    bool loadCheckpoint();
+
+    /// @brief Reassembles upper triangle entries in rows and columns of the DOFs from their elements
+    /// @details Only the elements around the DOFs are visited, the pattern of the matrix is kept
+    void restoreStiffness(const std::vector<Index> &dofs);
+
+    /// @brief Unconstrained stiffness matrix columns of the DOFs, assembled from their elements
+    /// @details Dense, used for at most MAX_UPDATED_DOFS DOFs of a low-rank update
+    Eigen::MatrixX<double> calculateStiffnessColumns(const std::vector<Index> &dofs);
+
+    /// @brief Expresses the difference of applied and factorized constraints as a low-rank update
+    /// @return false if the factorization has to be recomputed instead
+    bool updateFactorization();
+
+    /// @brief Sx, Sy, Sxy and von Mises stress of the element
+    std::vector<double> calculateElementStress(int element, const Eigen::Matrix3d &D);
     
 private:
     Geometry geometry;
-    Eigen::SparseMatrix<double> globalK; ///< stiffness matrix
+    SparseMatrix globalK; ///< stiffness matrix
     Eigen::VectorX<double> F; ///< load vector
     Eigen::VectorX<double> displacements; ///< results, available only after succesful Solver::solve call
 
     double poissonRatio; ///< Poisson ratio (should be element-specific in common case)
     double youngModulus; ///< Young modulus (should be element-specific in common case)
+
+    Backend backend;
+    std::unique_ptr<LinearSolver> linearSolver; ///< factorization of globalK, reset when matrix pattern is changed
+    bool isFactorized; ///< false if values of globalK were changed since the last factorization
+    std::vector<Index> appliedConstraints; ///< sorted DOFs constrained in globalK
+    std::vector<Index> factorizedConstraints; ///< sorted DOFs constrained in the factorized matrix
+    std::unique_ptr<LowRankUpdate> constraintUpdate; ///< difference of applied and factorized constraints, refers to linearSolver
+    std::unique_ptr<TriangleBvh> bvh; ///< point location for probe, reset when geometry is changed
+    double solutionScale; ///< solutions of the factorization are scaled by it, see setMaterial
+    std::string checkpointDirectory; ///< empty if checkpoints are disabled
+    bool isFromCheckpoint; ///< factorization was loaded and not computed
 };
 
 #endif /* SOLVER_HPP */
@@ -0,0 +1,165 @@
+#include "sparseKernels.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "parallel.hpp"
+
+void multiply(const RowMajorMatrix &A, const Eigen::VectorX<double> &x, Eigen::VectorX<double> &y)
+{
+    y.resize(A.rows());
+    parallelFor(0, A.rows(), [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            double sum = 0.0;
+            for (RowMajorMatrix::InnerIterator it(A, i); it; ++it)
+                sum += it.value() * x(it.col());
+            y(i) = sum;
+        }
+    });
+}
+
+void residual(const RowMajorMatrix &A, const Eigen::VectorX<double> &x, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &r)
+{
+    r.resize(A.rows());
+    parallelFor(0, A.rows(), [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            double sum = b(i);
+            for (RowMajorMatrix::InnerIterator it(A, i); it; ++it)
+                sum -= it.value() * x(it.col());
+            r(i) = sum;
+        }
+    });
+}
+
+/// @brief Adds row i of the upper triangle times x to y, y is indexed from offset
+static void accumulateSymmetricRow(const RowMajorMatrix &upper, int i, const Eigen::VectorX<double> &x, double *y, int offset)
+{
+    double sum = 0.0;
+    const double xi = x(i);
+    for (RowMajorMatrix::InnerIterator it(upper, i); it; ++it)
+    {
+        const int j = it.col();
+        if (j < i)
+            continue;
+        sum += it.value() * x(j);
+        if (j != i)
+            y[j - offset] += it.value() * xi;
+    }
+    y[i - offset] += sum;
+}
+
+void multiplySymmetric(const RowMajorMatrix &upper, const Eigen::VectorX<double> &x, Eigen::VectorX<double> &y)
+{
+    SymmetricProduct product;
+    product.compute(upper);
+    product.multiply(x, y);
+}
+
+void residualSymmetric(const RowMajorMatrix &upper, const Eigen::VectorX<double> &x, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &r)
+{
+    SymmetricProduct product;
+    product.compute(upper);
+    product.residual(x, b, r);
+}
+
+SymmetricProduct::SymmetricProduct()
+    : upper(nullptr), rowBegins(1, 0), bufferOffsets(1, 0) {};
+
+void SymmetricProduct::compute(const RowMajorMatrix &_upper)
+{
+    upper = &_upper;
+    const int n = upper->rows();
+    const int chunks = std::min(n, getThreadsCount());
+
+    rowBegins.resize(chunks + 1);
+    scatterEnds.resize(chunks);
+    bufferOffsets.resize(chunks + 1);
+    bufferOffsets[0] = 0;
+    for (int chunk = 0; chunk <= chunks; ++chunk)
+        rowBegins[chunk] = static_cast<long long>(n) * chunk / std::max(chunks, 1);
+    for (int chunk = 0; chunk < chunks; ++chunk)
+    {
+        // Rows of a chunk scatter only to the rows from its begin to their last column
+        int last = rowBegins[chunk + 1] - 1;
+        for (int i = rowBegins[chunk]; i < rowBegins[chunk + 1]; ++i)
+            for (RowMajorMatrix::InnerIterator it(*upper, i); it; ++it)
+                last = std::max<int>(last, it.col());
+        scatterEnds[chunk] = last + 1;
+        bufferOffsets[chunk + 1] = bufferOffsets[chunk] + scatterEnds[chunk] - rowBegins[chunk];
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.clear();
+}
+
+void SymmetricProduct::multiply(const Eigen::VectorX<double> &x, Eigen::VectorX<double> &y) const
+{
+    apply(x, nullptr, y);
+}
+
+void SymmetricProduct::residual(const Eigen::VectorX<double> &x, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &r) const
+{
+    apply(x, &b, r);
+}
+
+void SymmetricProduct::apply(const Eigen::VectorX<double> &x, const Eigen::VectorX<double> *b, Eigen::VectorX<double> &y) const
+{
+    const int n = rowBegins.back();
+    const int chunks = scatterEnds.size();
+    if (chunks <= 1)
+    {
+        y.setZero(n);
+        for (int i = 0; i < n; ++i)
+            accumulateSymmetricRow(*upper, i, x, y.data(), 0);
+        if (b)
+            y = *b - y;
+        return;
+    }
+
+    std::vector<double> buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!buffers.empty())
+        {
+            buffer = std::move(buffers.back());
+            buffers.pop_back();
+        }
+    }
+    buffer.resize(bufferOffsets.back());
+
+    parallelFor(0, chunks, [&](int begin, int end)
+    {
+        for (int chunk = begin; chunk < end; ++chunk)
+        {
+            double *scatter = buffer.data() + bufferOffsets[chunk];
+            std::fill(scatter, buffer.data() + bufferOffsets[chunk + 1], 0.0);
+            for (int i = rowBegins[chunk]; i < rowBegins[chunk + 1]; ++i)
+                accumulateSymmetricRow(*upper, i, x, scatter, rowBegins[chunk]);
+        }
+    });
+
+    // A row sums only the chunks whose ranges cover it
+    y.resize(n);
+    const double sign = b ? -1.0 : 1.0;
+    parallelFor(0, n, [&](int begin, int end)
+    {
+        if (b)
+            y.segment(begin, end - begin) = b->segment(begin, end - begin);
+        else
+            y.segment(begin, end - begin).setZero();
+        for (int chunk = 0; chunk < chunks && rowBegins[chunk] < end; ++chunk)
+        {
+            const double *scatter = buffer.data() + bufferOffsets[chunk];
+            const int last = std::min(end, scatterEnds[chunk]);
+            for (int i = std::max(begin, rowBegins[chunk]); i < last; ++i)
+                y(i) += sign * scatter[i - rowBegins[chunk]];
+        }
+    });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.push_back(std::move(buffer));
+}
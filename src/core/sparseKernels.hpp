@@ -0,0 +1,61 @@
+#ifndef SPARSE_KERNELS_HPP
+#define SPARSE_KERNELS_HPP
+
+#include <mutex>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "types.hpp"
+
+/// @brief Parallel sparse matrix-vector product y = A * x, rows are split between threads
+void multiply(const RowMajorMatrix &A, const Eigen::VectorX<double> &x, Eigen::VectorX<double> &y);
+
+/// @brief Parallel residual r = b - A * x
+void residual(const RowMajorMatrix &A, const Eigen::VectorX<double> &x, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &r);
+
+/// @brief Parallel product y = A * x of symmetric A given by its upper triangle, see SymmetricProduct
+/// @details Prepares the product for a single use, repeated products of one matrix keep a SymmetricProduct.
+void multiplySymmetric(const RowMajorMatrix &upper, const Eigen::VectorX<double> &x, Eigen::VectorX<double> &y);
+
+/// @brief Parallel residual r = b - A * x of symmetric A given by its upper triangle
+void residualSymmetric(const RowMajorMatrix &upper, const Eigen::VectorX<double> &x, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &r);
+
+/// @brief Parallel products of symmetric A given by its upper triangle
+/// @details Each stored entry is used twice: gathered into its row and scattered into its column.
+///          Rows are split into a chunk per thread. Scatters of a chunk go to its private buffer, which spans
+///          only the rows from the first row of the chunk to the last column it touches. The ranges are
+///          computed once by compute and the buffers are kept for later products, concurrent products take
+///          separate buffers. Every row sums the buffers of the chunks whose ranges cover it, so the result
+///          does not depend on the order of threads.
+class SymmetricProduct
+{
+public:
+    SymmetricProduct();
+
+    /// @brief Splits rows for the current number of threads, the matrix must outlive the products
+    void compute(const RowMajorMatrix &upper);
+
+    /// @brief y = A * x
+    void multiply(const Eigen::VectorX<double> &x, Eigen::VectorX<double> &y) const;
+    /// @brief r = b - A * x
+    void residual(const Eigen::VectorX<double> &x, const Eigen::VectorX<double> &b, Eigen::VectorX<double> &r) const;
+
+    /// @brief Number of rows of the buffers of all chunks
+    size_t getBufferSize() const { return bufferOffsets.back(); }
+
+private:
+    /// @brief y = A * x, or y = b - A * x if b is given
+    void apply(const Eigen::VectorX<double> &x, const Eigen::VectorX<double> *b, Eigen::VectorX<double> &y) const;
+
+    const RowMajorMatrix *upper;
+    std::vector<int> rowBegins;         ///< first row of each chunk and the number of rows
+    std::vector<int> scatterEnds;       ///< past the last row each chunk scatters to
+    std::vector<size_t> bufferOffsets;  ///< start of the buffer of each chunk and the total size
+
+    mutable std::mutex mutex;
+    mutable std::vector<std::vector<double>> buffers;   ///< free buffers of all chunks
+};
+
+#endif /* SPARSE_KERNELS_HPP */
@@ -0,0 +1,980 @@
+#include "supernodalCholesky.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parallel.hpp"
+#include "threadPool.hpp"
+
+/// Subgraphs smaller than this are not dissected further
+static const int DISSECTION_LEAF_SIZE = 64;
+/// Relaxed supernodes are merged while they are not wider than this
+static const int RELAXED_SUPERNODE_SIZE = 32;
+/// Allowed share of explicit zeros in a relaxed supernode
+static const double RELAXED_ZEROS_FRACTION = 0.2;
+/// Leading bytes of checkpoint files, the last one is the format version, 64-bit index builds use W for L
+static const char CHECKPOINT_MAGIC[8] = {'F', 'E', 'M', 'C', 'H', 'O', sizeof(Index) == 8 ? 'W' : 'L', '1'};
+/// Alignment of the factor in checkpoint files, so the mapped panels are aligned as allocated ones
+static const size_t CHECKPOINT_ALIGNMENT = 64;
+
+/// @brief Fixed part of a checkpoint, followed by perm, lowerPtr, lowerRows, lowerSource,
+///        supernodes (6 values each), rows and the factor at factorOffset
+struct CheckpointHeader
+{
+    char magic[8];
+    uint64_t key;
+    int64_t size;
+    int64_t supernodesCount;
+    int64_t lowerCount;
+    int64_t rowsCount;
+    int64_t factorSize;
+    int64_t factorOffset;
+};
+
+/// @brief Supernodes waiting for children and ready ones, shared with helper jobs which may outlive the factorization
+struct SupernodeTree
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<int> parents;
+    std::vector<int> pending;       ///< children not factorized yet
+    std::vector<int> ready;
+    std::function<bool(int)> factorize; ///< factorizes a supernode, called only while supernodes remain
+    ThreadPool *pool;               ///< pool of the caller or nullptr
+    int threadsCount;
+    int participants;               ///< caller and helpers taking supernodes
+    int remaining;
+    int running;                    ///< supernodes being factorized
+    bool failed;
+    std::vector<std::thread::id> workers; ///< threads which factorized supernodes, may repeat
+};
+
+/// @brief Factorizes ready supernodes until none remains
+/// @details Helpers return when nothing is ready instead of blocking pool workers, a new helper is queued
+///          whenever a supernode gets ready while fewer than threadsCount participants are active. The caller
+///          waits for supernodes being factorized, also after a failure, since they use its update matrices.
+static void processSupernodes(const std::shared_ptr<SupernodeTree> &tree, bool isHelper)
+{
+    std::unique_lock<std::mutex> lock(tree->mutex);
+    bool hasWorked = false;
+    while (true)
+    {
+        if (tree->remaining == 0 || tree->failed)
+        {
+            if (isHelper || tree->running == 0)
+                break;
+        }
+        else if (!tree->ready.empty())
+        {
+            const int s = tree->ready.back();
+            tree->ready.pop_back();
+            ++tree->running;
+            if (!hasWorked)
+            {
+                hasWorked = true;
+                tree->workers.push_back(std::this_thread::get_id());
+            }
+            lock.unlock();
+
+            bool success;
+            try
+            {
+                success = tree->factorize(s);
+            }
+            catch (...)
+            {
+                success = false;
+            }
+
+            lock.lock();
+            --tree->running;
+            --tree->remaining;
+            if (!success)
+                tree->failed = true;
+            const int parent = tree->parents[s];
+            if (parent != -1 && --tree->pending[parent] == 0)
+            {
+                tree->ready.push_back(parent);
+                if (tree->pool && tree->participants < tree->threadsCount)
+                {
+                    ++tree->participants;
+                    tree->pool->submit([tree] { processSupernodes(tree, true); });
+                }
+            }
+            tree->condition.notify_all();
+            continue;
+        }
+        else if (isHelper)
+        {
+            break;
+        }
+        tree->condition.wait(lock);
+    }
+    if (isHelper)
+        --tree->participants;
+}
+
+SupernodalCholesky::SupernodalCholesky() : size(0), factor(nullptr), factorSize(0), mapping(nullptr), mappingSize(0), workersCount(0) {};
+
+SupernodalCholesky::~SupernodalCholesky()
+{
+    unmap();
+}
+
+void SupernodalCholesky::unmap()
+{
+    if (mapping)
+        munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    factor = values.data();
+}
+
+std::vector<Index> SupernodalCholesky::nestedDissection(const std::vector<Index> &adjPtr, const std::vector<Index> &adj)
+{
+    const Index n = adjPtr.size() - 1;
+
+    std::vector<Index> order;
+    order.reserve(n);
+
+    std::vector<Index> subset(n, -1);  // stamp of the subgraph the vertex belongs to
+    std::vector<Index> seen(n, -1);    // stamp of the last search visited the vertex
+    std::vector<Index> level(n, -1);
+    Index stamp = 0;
+    Index searchStamp = 0;
+
+    // Breadth first search inside the subgraph, returns vertices in visiting order
+    auto bfs = [&](Index root, std::vector<Index> &visited, std::vector<Index> &levelStarts)
+    {
+        visited.clear();
+        levelStarts.clear();
+        const Index own = subset[root];
+        ++searchStamp;
+        visited.push_back(root);
+        level[root] = 0;
+        seen[root] = searchStamp;
+        for (size_t head = 0; head < visited.size(); ++head)
+        {
+            const Index v = visited[head];
+            if (levelStarts.size() <= level[v])
+                levelStarts.push_back(head);
+            for (Index p = adjPtr[v]; p < adjPtr[v + 1]; ++p)
+            {
+                const Index u = adj[p];
+                if (subset[u] == own && seen[u] != searchStamp)
+                {
+                    seen[u] = searchStamp;
+                    level[u] = level[v] + 1;
+                    visited.push_back(u);
+                }
+            }
+        }
+        levelStarts.push_back(visited.size());
+    };
+
+    struct Task
+    {
+        std::vector<Index> vertices;
+        bool isSeparator;
+    };
+
+    std::vector<Task> tasks;
+    std::vector<Index> all(n);
+    for (Index i = 0; i < n; ++i)
+        all[i] = i;
+    tasks.push_back(Task{all, false});
+
+    std::vector<Index> visited, levelStarts;
+    while (!tasks.empty())
+    {
+        Task task = std::move(tasks.back());
+        tasks.pop_back();
+        auto &vertices = task.vertices;
+
+        if (task.isSeparator || vertices.size() <= DISSECTION_LEAF_SIZE)
+        {
+            order.insert(order.end(), vertices.begin(), vertices.end());
+            continue;
+        }
+
+        ++stamp;
+        for (Index v: vertices)
+            subset[v] = stamp;
+
+        // Pseudo-peripheral vertex: restart from the farthest vertex of minimal degree while eccentricity grows
+        Index root = vertices[0];
+        bfs(root, visited, levelStarts);
+        for (Index attempt = 0; attempt < 4 && visited.size() == vertices.size(); ++attempt)
+        {
+            const Index height = levelStarts.size() - 1;
+            Index candidate = visited[levelStarts[height - 1]];
+            for (Index i = levelStarts[height - 1]; i < levelStarts[height]; ++i)
+                if (adjPtr[visited[i] + 1] - adjPtr[visited[i]] < adjPtr[candidate + 1] - adjPtr[candidate])
+                    candidate = visited[i];
+
+            std::vector<Index> candidateStarts;
+            std::vector<Index> candidateVisited;
+            bfs(candidate, candidateVisited, candidateStarts);
+            if (candidateStarts.size() <= levelStarts.size())
+            {
+                bfs(root, visited, levelStarts);
+                break;
+            }
+            root = candidate;
+            visited.swap(candidateVisited);
+            levelStarts.swap(candidateStarts);
+        }
+
+        // Disconnected subgraph: components are ordered independently
+        if (visited.size() < vertices.size())
+        {
+            std::vector<Index> rest;
+            for (Index v: vertices)
+                if (seen[v] != searchStamp)
+                    rest.push_back(v);
+            tasks.push_back(Task{rest, false});
+            tasks.push_back(Task{visited, false});
+            continue;
+        }
+
+        const Index height = levelStarts.size() - 1;
+        Index middle = 0;
+        while (middle < height && levelStarts[middle + 1] < vertices.size() / 2)
+            ++middle;
+
+        if (height < 3 || middle == 0 || middle == height - 1)
+        {
+            order.insert(order.end(), vertices.begin(), vertices.end());
+            continue;
+        }
+
+        // Middle level is separator, its vertices not adjacent to the next level go to the first part
+        std::vector<Index> first(visited.begin(), visited.begin() + levelStarts[middle]);
+        std::vector<Index> second(visited.begin() + levelStarts[middle + 1], visited.end());
+        std::vector<Index> separator;
+        for (Index i = levelStarts[middle]; i < levelStarts[middle + 1]; ++i)
+        {
+            const Index v = visited[i];
+            bool isAdjacent = false;
+            for (Index p = adjPtr[v]; p < adjPtr[v + 1] && !isAdjacent; ++p)
+                isAdjacent = subset[adj[p]] == stamp && level[adj[p]] == middle + 1;
+            if (isAdjacent)
+                separator.push_back(v);
+            else
+                first.push_back(v);
+        }
+
+        // Tasks are taken from the back: first part, second part, then separator
+        tasks.push_back(Task{separator, true});
+        tasks.push_back(Task{second, false});
+        tasks.push_back(Task{first, false});
+    }
+
+    return order;
+}
+
+void SupernodalCholesky::analyzePattern(const SparseMatrix &K)
+{
+    unmap();
+    size = K.rows();
+    const Index n = size;
+
+    // Adjacency graph of the matrix
+    std::vector<Index> degree(n, 0);
+    for (Index k = 0; k < K.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(K, k); it; ++it)
+            if (it.row() < k)
+            {
+                degree[it.row()]++;
+                degree[k]++;
+            }
+
+    std::vector<Index> adjPtr(n + 1, 0);
+    for (Index i = 0; i < n; ++i)
+        adjPtr[i + 1] = adjPtr[i] + degree[i];
+    std::vector<Index> adj(adjPtr[n]);
+    std::vector<Index> fill(adjPtr.begin(), adjPtr.end() - 1);
+    for (Index k = 0; k < K.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(K, k); it; ++it)
+            if (it.row() < k)
+            {
+                adj[fill[it.row()]++] = k;
+                adj[fill[k]++] = it.row();
+            }
+
+    perm = nestedDissection(adjPtr, adj);
+
+    // Upper pattern of the permuted matrix, column k keeps rows j < k, used by elimination tree
+    auto buildUpper = [&](std::vector<Index> &upperPtr, std::vector<Index> &upperRows)
+    {
+        iperm.resize(n);
+        for (Index k = 0; k < n; ++k)
+            iperm[perm[k]] = k;
+
+        upperPtr.assign(n + 1, 0);
+        for (Index v = 0; v < n; ++v)
+            for (Index p = adjPtr[v]; p < adjPtr[v + 1]; ++p)
+                if (iperm[adj[p]] < iperm[v])
+                    upperPtr[iperm[v] + 1]++;
+        for (Index k = 0; k < n; ++k)
+            upperPtr[k + 1] += upperPtr[k];
+        upperRows.resize(upperPtr[n]);
+        std::vector<Index> position(upperPtr.begin(), upperPtr.end() - 1);
+        for (Index v = 0; v < n; ++v)
+            for (Index p = adjPtr[v]; p < adjPtr[v + 1]; ++p)
+                if (iperm[adj[p]] < iperm[v])
+                    upperRows[position[iperm[v]]++] = iperm[adj[p]];
+    };
+
+    auto eliminationTree = [n](const std::vector<Index> &upperPtr, const std::vector<Index> &upperRows)
+    {
+        std::vector<Index> parent(n, -1);
+        std::vector<Index> ancestor(n, -1);
+        for (Index k = 0; k < n; ++k)
+        {
+            for (Index p = upperPtr[k]; p < upperPtr[k + 1]; ++p)
+            {
+                for (Index i = upperRows[p]; i != -1 && i < k; )
+                {
+                    const Index next = ancestor[i];
+                    ancestor[i] = k;
+                    if (next == -1)
+                        parent[i] = k;
+                    i = next;
+                }
+            }
+        }
+        return parent;
+    };
+
+    std::vector<Index> upperPtr, upperRows;
+    buildUpper(upperPtr, upperRows);
+    std::vector<Index> parent = eliminationTree(upperPtr, upperRows);
+
+    // Postorder the tree, so every subtree and every supernode are contiguous
+    {
+        std::vector<Index> head(n, -1), next(n, -1);
+        for (Index j = n - 1; j >= 0; --j)
+            if (parent[j] != -1)
+            {
+                next[j] = head[parent[j]];
+                head[parent[j]] = j;
+            }
+
+        std::vector<Index> post;
+        post.reserve(n);
+        std::vector<Index> stack;
+        for (Index root = 0; root < n; ++root)
+        {
+            if (parent[root] != -1)
+                continue;
+            stack.push_back(root);
+            while (!stack.empty())
+            {
+                const Index top = stack.back();
+                const Index child = head[top];
+                if (child == -1)
+                {
+                    post.push_back(top);
+                    stack.pop_back();
+                }
+                else
+                {
+                    head[top] = next[child];
+                    stack.push_back(child);
+                }
+            }
+        }
+
+        std::vector<Index> postPerm(n);
+        for (Index k = 0; k < n; ++k)
+            postPerm[k] = perm[post[k]];
+        perm.swap(postPerm);
+    }
+
+    buildUpper(upperPtr, upperRows);
+    parent = eliminationTree(upperPtr, upperRows);
+
+    // Lower triangle of the permuted matrix with links to values of K
+    lowerPtr.assign(n + 1, 0);
+    for (Index k = 0; k < K.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(K, k); it; ++it)
+            if (it.row() <= k)
+                lowerPtr[std::min(iperm[it.row()], iperm[k]) + 1]++;
+    for (Index j = 0; j < n; ++j)
+        lowerPtr[j + 1] += lowerPtr[j];
+    {
+        std::vector<std::pair<Index, Index>> entries(lowerPtr[n]);
+        std::vector<Index> position(lowerPtr.begin(), lowerPtr.end() - 1);
+        const Index *outer = K.outerIndexPtr();
+        for (Index k = 0; k < K.outerSize(); ++k)
+            for (Index p = outer[k]; p < outer[k] + (K.isCompressed() ? outer[k + 1] - outer[k] : K.innerNonZeroPtr()[k]); ++p)
+            {
+                const Index row = K.innerIndexPtr()[p];
+                if (row <= k)
+                {
+                    const Index i = iperm[row], j = iperm[k];
+                    entries[position[std::min(i, j)]++] = std::make_pair(std::max(i, j), p);
+                }
+            }
+        lowerRows.resize(lowerPtr[n]);
+        lowerSource.resize(lowerPtr[n]);
+        for (Index j = 0; j < n; ++j)
+        {
+            std::sort(entries.begin() + lowerPtr[j], entries.begin() + lowerPtr[j + 1]);
+            for (Index p = lowerPtr[j]; p < lowerPtr[j + 1]; ++p)
+            {
+                lowerRows[p] = entries[p].first;
+                lowerSource[p] = entries[p].second;
+            }
+        }
+        lowerValues.resize(lowerPtr[n]);
+    }
+
+    // Column counts by merging structures of children, children precede parents in postorder
+    std::vector<Index> colCount(n, 0);
+    {
+        std::vector<std::vector<Index>> structure(n);
+        std::vector<Index> merged;
+        for (Index j = 0; j < n; ++j)
+        {
+            merged.clear();
+            for (Index p = lowerPtr[j]; p < lowerPtr[j + 1]; ++p)
+                if (lowerRows[p] > j)
+                    merged.push_back(lowerRows[p]);
+            structure[j].swap(merged);
+        }
+
+        std::vector<Index> head(n, -1), next(n, -1);
+        for (Index j = n - 1; j >= 0; --j)
+            if (parent[j] != -1)
+            {
+                next[j] = head[parent[j]];
+                head[parent[j]] = j;
+            }
+
+        for (Index j = 0; j < n; ++j)
+        {
+            auto &own = structure[j];
+            for (Index child = head[j]; child != -1; child = next[child])
+            {
+                for (Index row: structure[child])
+                    if (row > j)
+                        own.push_back(row);
+                std::vector<Index>().swap(structure[child]);
+            }
+            std::sort(own.begin(), own.end());
+            own.erase(std::unique(own.begin(), own.end()), own.end());
+            colCount[j] = own.size();
+        }
+    }
+
+    // Fundamental supernodes, then relaxed amalgamation of a chain child with its parent
+    std::vector<Index> firsts;
+    for (Index j = 0; j < n; ++j)
+        if (j == 0 || parent[j - 1] != j || colCount[j - 1] != colCount[j] + 1)
+            firsts.push_back(j);
+    firsts.push_back(n);
+
+    std::vector<Index> relaxed;
+    {
+        Index groupFirst = firsts[0];
+        long long groupEntries = 0;
+        for (Index j = firsts[0]; j < firsts[1]; ++j)
+            groupEntries += colCount[j] + 1;
+        for (int s = 1; s < firsts.size() - 1; ++s)
+        {
+            const Index first = firsts[s], last = firsts[s + 1] - 1;
+            long long entries = 0;
+            for (Index j = first; j <= last; ++j)
+                entries += colCount[j] + 1;
+
+            const long long width = last - groupFirst + 1;
+            const long long dense = width * (width + 1) / 2 + width * colCount[last];
+            const bool isChain = parent[first - 1] == first;
+            if (isChain && width <= RELAXED_SUPERNODE_SIZE && dense - groupEntries - entries <= RELAXED_ZEROS_FRACTION * dense)
+            {
+                groupEntries += entries;
+                continue;
+            }
+            relaxed.push_back(groupFirst);
+            groupFirst = first;
+            groupEntries = entries;
+        }
+        relaxed.push_back(groupFirst);
+        relaxed.push_back(n);
+    }
+
+    // Supernodal structures
+    const int supernodesCount = relaxed.size() - 1;
+    std::vector<int> columnSupernode(n);
+    supernodes.assign(supernodesCount, Supernode());
+    for (int s = 0; s < supernodesCount; ++s)
+    {
+        supernodes[s].first = relaxed[s];
+        supernodes[s].count = relaxed[s + 1] - relaxed[s];
+        for (Index j = relaxed[s]; j < relaxed[s + 1]; ++j)
+            columnSupernode[j] = s;
+    }
+
+    children.assign(supernodesCount, std::vector<int>());
+    for (int s = 0; s < supernodesCount; ++s)
+    {
+        const Index last = supernodes[s].first + supernodes[s].count - 1;
+        supernodes[s].parent = parent[last] == -1 ? -1 : columnSupernode[parent[last]];
+        if (supernodes[s].parent != -1)
+            children[supernodes[s].parent].push_back(s);
+    }
+
+    rows.clear();
+    factorSize = 0;
+    std::vector<Index> merged;
+    for (int s = 0; s < supernodesCount; ++s)
+    {
+        Supernode &supernode = supernodes[s];
+        const Index last = supernode.first + supernode.count - 1;
+
+        merged.clear();
+        for (Index j = supernode.first; j <= last; ++j)
+            for (Index p = lowerPtr[j]; p < lowerPtr[j + 1]; ++p)
+                if (lowerRows[p] > last)
+                    merged.push_back(lowerRows[p]);
+        for (int child: children[s])
+            for (int p = 0; p < supernodes[child].rowsCount; ++p)
+                if (rows[supernodes[child].rowsOffset + p] > last)
+                    merged.push_back(rows[supernodes[child].rowsOffset + p]);
+        std::sort(merged.begin(), merged.end());
+        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+        supernode.rowsOffset = rows.size();
+        supernode.rowsCount = merged.size();
+        rows.insert(rows.end(), merged.begin(), merged.end());
+
+        supernode.valuesOffset = factorSize;
+        factorSize += static_cast<size_t>(supernode.count + supernode.rowsCount) * supernode.count;
+    }
+}
+
+bool SupernodalCholesky::factorizeSupernode(int s, std::vector<Eigen::MatrixX<double>> &updates)
+{
+    const Supernode &supernode = supernodes[s];
+    const int count = supernode.count;
+    const int frontSize = count + supernode.rowsCount;
+    const Index first = supernode.first;
+    const Index last = first + count - 1;
+    const Index *frontRows = rows.data() + supernode.rowsOffset;
+
+    // Local index of a global row inside the front
+    auto local = [&](Index row)
+    {
+        if (row <= last)
+            return static_cast<int>(row - first);
+        return count + static_cast<int>(std::lower_bound(frontRows, frontRows + supernode.rowsCount, row) - frontRows);
+    };
+
+    Eigen::MatrixX<double> front = Eigen::MatrixX<double>::Zero(frontSize, frontSize);
+
+    for (Index j = first; j <= last; ++j)
+        for (Index p = lowerPtr[j]; p < lowerPtr[j + 1]; ++p)
+            front(local(lowerRows[p]), j - first) += lowerValues[p];
+
+    // Extend-add of children update matrices
+    std::vector<int> map;
+    for (int child: children[s])
+    {
+        const Supernode &childNode = supernodes[child];
+        map.resize(childNode.rowsCount);
+        for (int i = 0; i < childNode.rowsCount; ++i)
+            map[i] = local(rows[childNode.rowsOffset + i]);
+
+        const Eigen::MatrixX<double> &update = updates[child];
+        for (int j = 0; j < childNode.rowsCount; ++j)
+            for (int i = j; i < childNode.rowsCount; ++i)
+                front(map[i], map[j]) += update(i, j);
+
+        Eigen::MatrixX<double>().swap(updates[child]);
+    }
+
+    // Dense partial factorization: L11 * L11^T = F11, L21 = F21 * L11^-T, U = F22 - L21 * L21^T
+    Eigen::Ref<Eigen::MatrixX<double>> F11 = front.topLeftCorner(count, count);
+    Eigen::LLT<Eigen::Ref<Eigen::MatrixX<double>>> llt(F11);
+    if (llt.info() != Eigen::Success)
+        return false;
+
+    const int rowsCount = supernode.rowsCount;
+    if (rowsCount > 0)
+    {
+        auto F21 = front.bottomLeftCorner(rowsCount, count);
+        F11.triangularView<Eigen::Lower>().transpose().solveInPlace<Eigen::OnTheRight>(F21);
+
+        updates[s] = front.bottomRightCorner(rowsCount, rowsCount);
+        updates[s].selfadjointView<Eigen::Lower>().rankUpdate(F21, -1.0);
+    }
+
+    Eigen::Map<Eigen::MatrixX<double>> panel(values.data() + supernode.valuesOffset, frontSize, count);
+    panel = front.leftCols(count);
+    return true;
+}
+
+void SupernodalCholesky::factorize(const SparseMatrix &K)
+{
+    if (K.rows() != size)
+        throw "Matrix does not match analyzed pattern";
+
+    const double *source = K.valuePtr();
+    // Entries of an uncompressed matrix are within the outer index too
+    const Index nonZeros = K.outerIndexPtr()[K.outerSize()];
+    for (size_t p = 0; p < lowerValues.size(); ++p)
+    {
+        if (lowerSource[p] >= nonZeros)
+            throw "Matrix does not match analyzed pattern";
+        lowerValues[p] = source[lowerSource[p]];
+    }
+
+    unmap();
+    values.assign(factorSize, 0.0);
+    factor = values.data();
+
+    const int supernodesCount = supernodes.size();
+    std::vector<Eigen::MatrixX<double>> updates(supernodesCount);
+
+    // Tree-level parallelism: a supernode is ready when all its children are factorized
+    auto tree = std::make_shared<SupernodeTree>();
+    tree->parents.resize(supernodesCount);
+    tree->pending.resize(supernodesCount);
+    for (int s = 0; s < supernodesCount; ++s)
+    {
+        tree->parents[s] = supernodes[s].parent;
+        tree->pending[s] = children[s].size();
+        if (children[s].empty())
+            tree->ready.push_back(s);
+    }
+    tree->factorize = [this, &updates](int s) { return factorizeSupernode(s, updates); };
+    tree->pool = ThreadPool::getCurrent();
+    tree->threadsCount = std::min(getThreadsCount(), supernodesCount);
+    tree->participants = 1;
+    tree->remaining = supernodesCount;
+    tree->running = 0;
+    tree->failed = false;
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(tree->mutex);
+        for (; tree->participants < tree->threadsCount; ++tree->participants)
+        {
+            // Batch jobs share the pool of their worker instead of starting threads of their own
+            if (tree->pool)
+                tree->pool->submit([tree] { processSupernodes(tree, true); });
+            else
+                threads.emplace_back(processSupernodes, tree, false);
+        }
+    }
+    processSupernodes(tree, false);
+    for (auto &thread: threads)
+        thread.join();
+
+    std::sort(tree->workers.begin(), tree->workers.end());
+    workersCount = std::unique(tree->workers.begin(), tree->workers.end()) - tree->workers.begin();
+
+    if (tree->failed)
+        throw "Factorization failed";
+}
+
+Eigen::VectorX<double> SupernodalCholesky::solve(const Eigen::VectorX<double> &F) const
+{
+    Eigen::VectorX<double> y(size);
+    for (Index k = 0; k < size; ++k)
+        y(k) = F(perm[k]);
+
+    Eigen::VectorX<double> buffer;
+
+    // Forward substitution L * z = y
+    for (const Supernode &supernode: supernodes)
+    {
+        const int count = supernode.count;
+        Eigen::Map<const Eigen::MatrixX<double>> panel(factor + supernode.valuesOffset, count + supernode.rowsCount, count);
+
+        auto x = y.segment(supernode.first, count);
+        panel.topRows(count).triangularView<Eigen::Lower>().solveInPlace(x);
+
+        buffer = panel.bottomRows(supernode.rowsCount) * x;
+        for (int i = 0; i < supernode.rowsCount; ++i)
+            y(rows[supernode.rowsOffset + i]) -= buffer(i);
+    }
+
+    // Backward substitution L^T * x = z
+    for (auto it = supernodes.rbegin(); it != supernodes.rend(); ++it)
+    {
+        const Supernode &supernode = *it;
+        const int count = supernode.count;
+        Eigen::Map<const Eigen::MatrixX<double>> panel(factor + supernode.valuesOffset, count + supernode.rowsCount, count);
+
+        buffer.resize(supernode.rowsCount);
+        for (int i = 0; i < supernode.rowsCount; ++i)
+            buffer(i) = y(rows[supernode.rowsOffset + i]);
+
+        auto x = y.segment(supernode.first, count);
+        x -= panel.bottomRows(supernode.rowsCount).transpose() * buffer;
+        panel.topRows(count).transpose().triangularView<Eigen::Upper>().solveInPlace(x);
+    }
+
+    Eigen::VectorX<double> result(size);
+    for (Index k = 0; k < size; ++k)
+        result(perm[k]) = y(k);
+    return result;
+}
+
+void SupernodalCholesky::save(const std::string &filename, uint64_t key) const
+{
+    if (!factor)
+        throw "Matrix is not factorized";
+
+    CheckpointHeader header;
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.key = key;
+    header.size = size;
+    header.supernodesCount = supernodes.size();
+    header.lowerCount = lowerRows.size();
+    header.rowsCount = rows.size();
+    header.factorSize = factorSize;
+
+    std::vector<int64_t> nodes;
+    nodes.reserve(6 * supernodes.size());
+    for (const Supernode &supernode: supernodes)
+    {
+        nodes.push_back(supernode.first);
+        nodes.push_back(supernode.count);
+        nodes.push_back(supernode.parent);
+        nodes.push_back(supernode.rowsOffset);
+        nodes.push_back(supernode.rowsCount);
+        nodes.push_back(supernode.valuesOffset);
+    }
+
+    const size_t metadataEnd = sizeof(header) + sizeof(Index) * (perm.size() + lowerPtr.size() + lowerRows.size() + lowerSource.size() + rows.size())
+                               + sizeof(int64_t) * nodes.size();
+    header.factorOffset = (metadataEnd + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT * CHECKPOINT_ALIGNMENT;
+
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::binary);
+        if (!output.is_open())
+            throw "File not found";
+
+        auto write = [&output](const void *data, size_t bytes) { output.write(static_cast<const char *>(data), bytes); };
+        write(&header, sizeof(header));
+        write(perm.data(), sizeof(Index) * perm.size());
+        write(lowerPtr.data(), sizeof(Index) * lowerPtr.size());
+        write(lowerRows.data(), sizeof(Index) * lowerRows.size());
+        write(lowerSource.data(), sizeof(Index) * lowerSource.size());
+        write(nodes.data(), sizeof(int64_t) * nodes.size());
+        write(rows.data(), sizeof(Index) * rows.size());
+        const std::vector<char> padding(header.factorOffset - metadataEnd, 0);
+        write(padding.data(), padding.size());
+        write(factor, sizeof(double) * factorSize);
+
+        if (!output)
+        {
+            output.close();
+            std::remove(temporary.c_str());
+            throw "Checkpoint is not written";
+        }
+    }
+
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        throw "Checkpoint is not written";
+    }
+}
+
+/// @brief Checks that a loaded structure is safe to use as indices
+/// @details perm must be a permutation, the lower pattern stored by columns with rows in the lower triangle,
+///          supernodes must cover columns, rows and the factor in order with parents after children, and every
+///          entry of a front, its own or of a child update, must have a place in it.
+/// @param nodes first, count, parent, rowsOffset, rowsCount and valuesOffset of each supernode
+static bool isValidStructure(Index size, const std::vector<Index> &perm, const std::vector<Index> &lowerPtr,
+                             const std::vector<Index> &lowerRows, const std::vector<Index> &lowerSource,
+                             const std::vector<int64_t> &nodes, const std::vector<Index> &rows, int64_t factorSize)
+{
+    std::vector<char> isSeen(size, 0);
+    for (Index old: perm)
+    {
+        if (old < 0 || old >= size || isSeen[old])
+            return false;
+        isSeen[old] = 1;
+    }
+
+    if (lowerPtr[0] != 0 || static_cast<int64_t>(lowerPtr[size]) != static_cast<int64_t>(lowerRows.size()))
+        return false;
+    for (Index j = 0; j < size; ++j)
+        if (lowerPtr[j + 1] < lowerPtr[j])
+            return false;
+    for (Index j = 0; j < size; ++j)
+        for (Index p = lowerPtr[j]; p < lowerPtr[j + 1]; ++p)
+            if (lowerRows[p] < j || lowerRows[p] >= size || lowerSource[p] < 0)
+                return false;
+
+    const int64_t supernodesCount = nodes.size() / 6;
+    int64_t column = 0, rowsEnd = 0, valuesEnd = 0;
+    for (int64_t s = 0; s < supernodesCount; ++s)
+    {
+        const int64_t *node = nodes.data() + 6 * s;
+        const int64_t first = node[0], count = node[1], parent = node[2], rowsOffset = node[3], rowsCount = node[4];
+        if (first != column || count < 1 || count > size - first || (parent != -1 && (parent <= s || parent >= supernodesCount))
+            || rowsOffset != rowsEnd || rowsCount < 0 || rowsCount > static_cast<int64_t>(rows.size()) - rowsOffset
+            || count + rowsCount > std::numeric_limits<int>::max() || node[5] != valuesEnd
+            || count + rowsCount > (factorSize - valuesEnd) / count)
+            return false;
+
+        for (int64_t i = rowsOffset; i < rowsOffset + rowsCount; ++i)
+            if (rows[i] < first + count || rows[i] >= size || (i > rowsOffset && rows[i] <= rows[i - 1]))
+                return false;
+
+        column += count;
+        rowsEnd += rowsCount;
+        valuesEnd += (count + rowsCount) * count;
+    }
+    if (column != size || rowsEnd != static_cast<int64_t>(rows.size()) || valuesEnd != factorSize)
+        return false;
+
+    // Rows of a front are its columns and its sorted rows
+    auto isInFront = [&](int64_t s, Index row)
+    {
+        const int64_t *node = nodes.data() + 6 * s;
+        const Index *frontRows = rows.data() + node[3];
+        return (row >= node[0] && row < node[0] + node[1]) || std::binary_search(frontRows, frontRows + node[4], row);
+    };
+    for (int64_t s = 0; s < supernodesCount; ++s)
+    {
+        const int64_t *node = nodes.data() + 6 * s;
+        for (Index j = node[0]; j < node[0] + node[1]; ++j)
+            for (Index p = lowerPtr[j]; p < lowerPtr[j + 1]; ++p)
+                if (!isInFront(s, lowerRows[p]))
+                    return false;
+        if (node[2] != -1)
+            for (int64_t i = node[3]; i < node[3] + node[4]; ++i)
+                if (!isInFront(node[2], rows[i]))
+                    return false;
+    }
+    return true;
+}
+
+bool SupernodalCholesky::load(const std::string &filename, uint64_t key)
+{
+    const int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(CheckpointHeader)))
+    {
+        close(file);
+        return false;
+    }
+
+    const size_t fileSize = status.st_size;
+    void *data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(file);
+    if (data == MAP_FAILED)
+        return false;
+
+    const char *bytes = static_cast<const char *>(data);
+    CheckpointHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    // Sizes are validated before anything is read, a truncated or foreign file is just a miss. Counts are
+    // bounded by the file size first, so the offsets computed from them can't wrap
+    const int64_t fileBytes = fileSize;
+    const int64_t maxCount = std::min<int64_t>(fileBytes / sizeof(Index), std::numeric_limits<Index>::max() - 1);
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 || header.key != key
+        || header.size < 0 || header.size > maxCount || header.lowerCount < 0 || header.lowerCount > maxCount
+        || header.rowsCount < 0 || header.rowsCount > maxCount
+        || header.supernodesCount < 0 || header.supernodesCount > fileBytes / static_cast<int64_t>(6 * sizeof(int64_t))
+        || header.factorSize < 0 || header.factorSize > fileBytes / static_cast<int64_t>(sizeof(double)))
+    {
+        munmap(data, fileSize);
+        return false;
+    }
+    const int64_t metadataEnd = sizeof(header) + sizeof(Index) * (2 * header.size + 1 + 2 * header.lowerCount + header.rowsCount)
+                                + sizeof(int64_t) * 6 * header.supernodesCount;
+    if (header.factorOffset < metadataEnd || header.factorOffset % CHECKPOINT_ALIGNMENT != 0 || header.factorOffset > fileBytes
+        || fileBytes - header.factorOffset != static_cast<int64_t>(sizeof(double)) * header.factorSize)
+    {
+        munmap(data, fileSize);
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    auto read = [&](std::vector<Index> &target, size_t count)
+    {
+        target.resize(count);
+        std::memcpy(target.data(), bytes + offset, sizeof(Index) * count);
+        offset += sizeof(Index) * count;
+    };
+
+    // Contents are read aside, the solver is changed only by a valid checkpoint
+    std::vector<Index> loadedPerm, loadedLowerPtr, loadedLowerRows, loadedLowerSource, loadedRows;
+    read(loadedPerm, header.size);
+    read(loadedLowerPtr, header.size + 1);
+    read(loadedLowerRows, header.lowerCount);
+    read(loadedLowerSource, header.lowerCount);
+    std::vector<int64_t> nodes(6 * header.supernodesCount);
+    std::memcpy(nodes.data(), bytes + offset, sizeof(int64_t) * nodes.size());
+    offset += sizeof(int64_t) * nodes.size();
+    read(loadedRows, header.rowsCount);
+
+    if (!isValidStructure(header.size, loadedPerm, loadedLowerPtr, loadedLowerRows, loadedLowerSource, nodes, loadedRows,
+                          header.factorSize))
+    {
+        munmap(data, fileSize);
+        return false;
+    }
+
+    unmap();
+    size = header.size;
+    perm.swap(loadedPerm);
+    lowerPtr.swap(loadedLowerPtr);
+    lowerRows.swap(loadedLowerRows);
+    lowerSource.swap(loadedLowerSource);
+    lowerValues.resize(header.lowerCount);
+    rows.swap(loadedRows);
+
+    iperm.resize(size);
+    for (Index k = 0; k < size; ++k)
+        iperm[perm[k]] = k;
+
+    supernodes.resize(header.supernodesCount);
+    children.assign(header.supernodesCount, std::vector<int>());
+    for (int s = 0; s < supernodes.size(); ++s)
+    {
+        supernodes[s].first = nodes[6 * s + 0];
+        supernodes[s].count = nodes[6 * s + 1];
+        supernodes[s].parent = nodes[6 * s + 2];
+        supernodes[s].rowsOffset = nodes[6 * s + 3];
+        supernodes[s].rowsCount = nodes[6 * s + 4];
+        supernodes[s].valuesOffset = nodes[6 * s + 5];
+        if (supernodes[s].parent != -1)
+            children[supernodes[s].parent].push_back(s);
+    }
+
+    std::vector<double>().swap(values);
+    factorSize = header.factorSize;
+    mapping = data;
+    mappingSize = fileSize;
+    factor = reinterpret_cast<const double *>(bytes + header.factorOffset);
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef SUPERNODAL_CHOLESKY_HPP
+#define SUPERNODAL_CHOLESKY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "linearSolver.hpp"
+
+/// @brief Multifrontal supernodal Cholesky factorization L * L^T
+/// @details Symbolic phase orders the matrix with nested dissection, postorders the elimination tree
+///          and groups columns with nested structure into (relaxed) supernodes. Numeric phase factorizes
+///          dense frontal matrices of supernodes with blocked kernels. Independent subtrees of the
+///          elimination tree are processed concurrently by getThreadsCount() threads, on a ThreadPool worker
+///          they are jobs of its pool.
+///          Only the upper triangle of the matrix is read.
+///          The whole factorization can be saved to a binary checkpoint, a loaded checkpoint maps the
+///          factor read-only into memory and is ready for solves without any analysis.
+class SupernodalCholesky: public LinearSolver
+{
+public:
+    SupernodalCholesky();
+    virtual ~SupernodalCholesky();
+
+    SupernodalCholesky(const SupernodalCholesky &) = delete;
+    SupernodalCholesky& operator=(const SupernodalCholesky &) = delete;
+
+    virtual void analyzePattern(const SparseMatrix &K);
+    virtual void factorize(const SparseMatrix &K);
+    virtual Eigen::VectorX<double> solve(const Eigen::VectorX<double> &F) const;
+
+    /// @brief Fill-reducing permutation, new index to original one
+    const std::vector<Index>& getPermutation() const { return perm; }
+    int getSupernodesCount() const { return supernodes.size(); }
+    /// @brief Number of stored entries of L, including explicit zeros of relaxed supernodes
+    size_t getFactorSize() const { return factorSize; }
+    /// @brief Number of threads which factorized supernodes in the last factorization
+    int getWorkersCount() const { return workersCount; }
+
+    /// @brief Saves ordering, symbolic structure and numeric factor
+    /// @details The file is written next to the target and renamed, so concurrent readers never see
+    ///          a partial checkpoint. The format is native binary, it is not portable between platforms.
+    /// @param key identifies the factorized matrix, see Solver::getCheckpointKey
+    void save(const std::string &filename, uint64_t key) const;
+
+    /// @brief Loads a checkpoint saved by save, the factor is memory mapped
+    /// @details The pattern kept in the checkpoint also allows to factorize a matrix with new values.
+    /// @return false if the file does not exist, has another key or format or inconsistent contents, the solver is
+    ///         not changed then
+    bool load(const std::string &filename, uint64_t key);
+
+    /// @brief Nested dissection ordering of the graph in CSR format
+    /// @return new index to old index permutation
+    static std::vector<Index> nestedDissection(const std::vector<Index> &adjPtr, const std::vector<Index> &adj);
+
+protected:
+    struct Supernode
+    {
+        Index first;        ///< first column
+        int count;          ///< number of columns
+        int parent;         ///< parent supernode or -1
+        size_t rowsOffset;  ///< offset of off-diagonal rows in rows
+        int rowsCount;      ///< number of off-diagonal rows
+        size_t valuesOffset;///< offset of the (count + rowsCount) x count column-major panel in values
+    };
+
+    /// @brief Dense partial factorization of the supernode front
+    /// @return false if matrix is not positive definite
+    bool factorizeSupernode(int s, std::vector<Eigen::MatrixX<double>> &updates);
+
+    /// @brief Releases the mapped checkpoint, the factor points to values then
+    void unmap();
+
+private:
+    Index size;
+    std::vector<Index> perm;        ///< new to old index
+    std::vector<Index> iperm;       ///< old to new index
+
+    /// Lower triangle of permuted matrix, values are taken from the original one by lowerSource
+    std::vector<Index> lowerPtr;
+    std::vector<Index> lowerRows;
+    std::vector<Index> lowerSource;
+    std::vector<double> lowerValues;
+
+    std::vector<Supernode> supernodes;
+    std::vector<std::vector<int>> children;
+    std::vector<Index> rows;
+    std::vector<double> values;
+    const double *factor;           ///< values or the factor of the mapped checkpoint
+    size_t factorSize;
+
+    void *mapping;                  ///< mapped checkpoint or nullptr
+    size_t mappingSize;
+    int workersCount;
+};
+
+#endif /* SUPERNODAL_CHOLESKY_HPP */
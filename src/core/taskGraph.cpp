@@ -0,0 +1,92 @@
+#include "taskGraph.hpp"
+
+TaskGraph::TaskGraph() {};
+
+int TaskGraph::add(const std::string &name, std::function<void()> body, const std::vector<int> &dependencies)
+{
+    const int index = tasks.size();
+    for (int dependency: dependencies)
+    {
+        if (dependency < 0 || dependency >= index)
+            throw "Wrong task dependency";
+        tasks[dependency].dependents.push_back(index);
+    }
+    tasks.push_back({name, std::move(body), {}, static_cast<int>(dependencies.size()), 0.0, 0.0, false});
+    return index;
+}
+
+void TaskGraph::run(ThreadPool &pool)
+{
+    remaining.resize(tasks.size());
+    isFailedDependency.assign(tasks.size(), 0);
+    error = nullptr;
+    startTime = std::chrono::steady_clock::now();
+
+    std::vector<int> ready;
+    for (int i = 0; i < tasks.size(); ++i)
+    {
+        remaining[i] = tasks[i].dependenciesCount;
+        tasks[i].isSkipped = false;
+        if (remaining[i] == 0)
+            ready.push_back(i);
+    }
+    for (int index: ready)
+        pool.submit([this, index, &pool] { execute(index, pool); });
+
+    pool.wait();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void TaskGraph::execute(int index, ThreadPool &pool)
+{
+    Task &task = tasks[index];
+    task.start = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    bool isFailed = false;
+    bool isSkipped;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isSkipped = isFailedDependency[index];
+    }
+    if (isSkipped)
+    {
+        task.isSkipped = true;
+        isFailed = true;
+    }
+    else
+    {
+        try
+        {
+            task.body();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            isFailed = true;
+        }
+    }
+
+    task.finish = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    finish(index, isFailed, pool);
+}
+
+void TaskGraph::finish(int index, bool isFailed, ThreadPool &pool)
+{
+    // Dependents are submitted before this job returns, so the pool is never idle in between
+    std::vector<int> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int dependent: tasks[index].dependents)
+        {
+            if (isFailed)
+                isFailedDependency[dependent] = 1;
+            if (--remaining[dependent] == 0)
+                ready.push_back(dependent);
+        }
+    }
+    for (int dependent: ready)
+        pool.submit([this, dependent, &pool] { execute(dependent, pool); });
+}
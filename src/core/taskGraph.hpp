@@ -0,0 +1,57 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "threadPool.hpp"
+
+/// @brief Tasks with dependencies executed on a thread pool
+/// @details A task is submitted as soon as all its dependencies are finished, so independent tasks run
+///          concurrently. If a task throws, its dependents are skipped, the rest of the graph is finished
+///          and the first exception is rethrown by run.
+class TaskGraph
+{
+public:
+    /// @brief Execution record of a task, times are in seconds from the start of run
+    struct Task
+    {
+        std::string name;
+        std::function<void()> body;
+        std::vector<int> dependents;
+        int dependenciesCount;
+        double start;
+        double finish;
+        bool isSkipped;
+    };
+
+    TaskGraph();
+
+    /// @brief Adds a task
+    /// @param dependencies tasks to be finished before this one, must be added before
+    /// @return task index
+    int add(const std::string &name, std::function<void()> body, const std::vector<int> &dependencies = {});
+
+    /// @brief Executes all tasks and blocks until they are finished
+    void run(ThreadPool &pool);
+
+    const std::vector<Task>& getTasks() const { return tasks; }
+
+private:
+    void execute(int index, ThreadPool &pool);
+    /// @brief Marks the task finished and submits dependents which became ready
+    void finish(int index, bool isFailed, ThreadPool &pool);
+
+    std::vector<Task> tasks;
+    std::vector<int> remaining;
+    std::vector<char> isFailedDependency;
+    std::chrono::steady_clock::time_point startTime;
+    std::mutex mutex;
+    std::exception_ptr error;
+};
+
+#endif /* TASK_GRAPH_HPP */
@@ -0,0 +1,116 @@
+#include "threadPool.hpp"
+
+#include <algorithm>
+
+/// Pool and deque index of the calling worker thread
+static thread_local ThreadPool *currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+ThreadPool::ThreadPool(int threadsCount) : pending(0), running(0), isStopping(false)
+{
+    const int count = std::max(1, threadsCount);
+    for (int i = 0; i <= count; ++i)
+        queues.emplace_back(new Queue());
+    for (int i = 0; i < count; ++i)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    jobAvailable.notify_all();
+    for (auto &worker: workers)
+        worker.join();
+}
+
+ThreadPool* ThreadPool::getCurrent()
+{
+    return currentPool;
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    Queue &queue = currentPool == this ? *queues[currentWorker] : *queues.back();
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    // The counter is changed under the pool mutex, so a worker going to sleep can not miss the job
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+    jobAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return pending == 0 && running == 0; });
+}
+
+bool ThreadPool::take(int index, std::function<void()> &job)
+{
+    const int count = workers.size();
+    for (int i = 0; i <= count; ++i)
+    {
+        // Own deque first, then the other workers starting from the next one, the shared queue is the last
+        const int victim = i == count ? count : (index + i) % count;
+        Queue &queue = *queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            continue;
+        if (victim == index)
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+        else
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::work(int index)
+{
+    currentPool = this;
+    currentWorker = index;
+    while (true)
+    {
+        std::function<void()> job;
+        if (!take(index, job))
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return isStopping || pending > 0; });
+            if (pending == 0)
+                return;
+            // The job may be taken by another worker between its push and the counter update
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --pending;
+            ++running;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            if (pending == 0 && running == 0)
+                idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Fixed set of worker threads executing submitted jobs with work stealing
+/// @details Every worker owns a deque. Jobs submitted by a worker go to its own deque and are taken
+///          newest first, jobs submitted from other threads go to a shared queue in FIFO order.
+///          An idle worker steals the oldest jobs of other workers before taking new ones from the
+///          shared queue, so nested work of running jobs is finished first.
+class ThreadPool
+{
+public:
+    /// @param threadsCount number of workers, at least one
+    explicit ThreadPool(int threadsCount);
+    /// @brief Waits for submitted jobs and stops workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// @brief Queues the job, jobs must not throw
+    void submit(std::function<void()> job);
+
+    /// @brief Blocks until the queues are empty and no job is running, must not be called by a worker
+    void wait();
+
+    int getThreadsCount() const { return workers.size(); }
+
+    /// @brief Pool of the calling worker thread, nullptr for other threads
+    static ThreadPool* getCurrent();
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    void work(int index);
+    /// @brief Takes a job from the own deque, other workers or the shared queue, in this order
+    bool take(int index, std::function<void()> &job);
+
+    std::vector<std::thread> workers;
+    /// Deques of the workers followed by the shared queue
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable idle;
+    int pending;
+    int running;
+    bool isStopping;
+};
+
+#endif /* THREAD_POOL_HPP */
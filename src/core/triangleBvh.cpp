@@ -0,0 +1,162 @@
+#include "triangleBvh.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+/// Triangles per leaf
+static const int LEAF_SIZE = 4;
+/// Points on common edges and slightly outside of the boundary due to round-off are still found
+static const double TOLERANCE = 1.e-12;
+static const int MAX_DEPTH = 64;
+
+TriangleBvh::TriangleBvh() : root(-1), rootCount(0), depth(0) {};
+
+void TriangleBvh::build(const std::vector<Element*> &elements)
+{
+    const int count = elements.size();
+    std::vector<Triangle> source(count);
+    std::vector<double> centroids(2 * count);
+    std::vector<double> sourceBoxes(4 * count);
+    for (int i = 0; i < count; ++i)
+    {
+        const Node &a = elements[i]->getNode(0), &b = elements[i]->getNode(1), &c = elements[i]->getNode(2);
+        const double e1x = b.x - a.x, e1y = b.y - a.y, e2x = c.x - a.x, e2y = c.y - a.y;
+        const double det = e1x * e2y - e2x * e1y;
+        const double scale = det != 0.0 ? 1.0 / det : 0.0;
+
+        Triangle &t = source[i];
+        t.x0 = a.x;
+        t.y0 = a.y;
+        t.inverse[0] = e2y * scale;
+        t.inverse[1] = -e2x * scale;
+        t.inverse[2] = -e1y * scale;
+        t.inverse[3] = e1x * scale;
+        t.element = i;
+
+        centroids[2 * i + 0] = (a.x + b.x + c.x) / 3.0;
+        centroids[2 * i + 1] = (a.y + b.y + c.y) / 3.0;
+        sourceBoxes[4 * i + 0] = std::min({a.x, b.x, c.x});
+        sourceBoxes[4 * i + 1] = std::min({a.y, b.y, c.y});
+        sourceBoxes[4 * i + 2] = std::max({a.x, b.x, c.x});
+        sourceBoxes[4 * i + 3] = std::max({a.y, b.y, c.y});
+    }
+
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+
+    nodes.clear();
+    nodes.reserve(count / LEAF_SIZE + 1);
+    boxes.swap(sourceBoxes);
+    depth = 0;
+    rootCount = count;
+    root = count > 0 ? buildNode(order, centroids, 0, count, 1, rootBox) : -1;
+
+    // Leaves refer to the ranges of order, triangles and boxes are reordered to match
+    triangles.resize(count);
+    std::vector<double> sorted(4 * count);
+    for (int i = 0; i < count; ++i)
+    {
+        triangles[i] = source[order[i]];
+        std::copy(boxes.begin() + 4 * order[i], boxes.begin() + 4 * order[i] + 4, sorted.begin() + 4 * i);
+    }
+    boxes.swap(sorted);
+}
+
+int TriangleBvh::buildNode(std::vector<int> &order, const std::vector<double> &centroids, int begin, int end, int level, double box[4])
+{
+    depth = std::max(depth, level);
+
+    double centroidBox[4] = {centroids[2 * order[begin]], centroids[2 * order[begin] + 1], centroids[2 * order[begin]], centroids[2 * order[begin] + 1]};
+    std::copy(boxes.begin() + 4 * order[begin], boxes.begin() + 4 * order[begin] + 4, box);
+    for (int i = begin; i < end; ++i)
+    {
+        const double *b = &boxes[4 * order[i]];
+        const double *c = &centroids[2 * order[i]];
+        for (int k = 0; k < 2; ++k)
+        {
+            box[k] = std::min(box[k], b[k]);
+            box[k + 2] = std::max(box[k + 2], b[k + 2]);
+            centroidBox[k] = std::min(centroidBox[k], c[k]);
+            centroidBox[k + 2] = std::max(centroidBox[k + 2], c[k]);
+        }
+    }
+
+    if (end - begin <= LEAF_SIZE || level >= MAX_DEPTH)
+        return -1 - begin;
+
+    const int axis = centroidBox[2] - centroidBox[0] >= centroidBox[3] - centroidBox[1] ? 0 : 1;
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                     [&centroids, axis](int lhs, int rhs) { return centroids[2 * lhs + axis] < centroids[2 * rhs + axis]; });
+
+    // Children are built into locals, nodes may be reallocated meanwhile
+    const int index = nodes.size();
+    nodes.push_back(BvhNode());
+    double leftBox[4], rightBox[4];
+    const int left = buildNode(order, centroids, begin, middle, level + 1, leftBox);
+    const int right = buildNode(order, centroids, middle, end, level + 1, rightBox);
+
+    BvhNode &node = nodes[index];
+    std::copy(leftBox, leftBox + 4, node.boxes[0]);
+    std::copy(rightBox, rightBox + 4, node.boxes[1]);
+    node.children[0] = left;
+    node.children[1] = right;
+    node.counts[0] = middle - begin;
+    node.counts[1] = end - middle;
+    return index;
+}
+
+int TriangleBvh::find(double x, double y, double weights[3]) const
+{
+    if (rootCount == 0)
+        return -1;
+    if (x < rootBox[0] || y < rootBox[1] || x > rootBox[2] || y > rootBox[3])
+        return -1;
+
+    // Stack of child references with their triangles counts
+    int stack[2 * MAX_DEPTH + 2];
+    int size = 0;
+    stack[size++] = root;
+    stack[size++] = rootCount;
+    while (size > 0)
+    {
+        const int count = stack[--size];
+        const int reference = stack[--size];
+
+        if (reference >= 0)
+        {
+            const BvhNode &node = nodes[reference];
+            for (int k = 1; k >= 0; --k)
+            {
+                const double *b = node.boxes[k];
+                if (x < b[0] || y < b[1] || x > b[2] || y > b[3])
+                    continue;
+                stack[size++] = node.children[k];
+                stack[size++] = node.counts[k];
+            }
+            continue;
+        }
+
+        const int first = -1 - reference;
+        for (int i = first; i < first + count; ++i)
+        {
+            const double *b = &boxes[4 * i];
+            if (x < b[0] || y < b[1] || x > b[2] || y > b[3])
+                continue;
+
+            const Triangle &t = triangles[i];
+            const double dx = x - t.x0, dy = y - t.y0;
+            const double l1 = t.inverse[0] * dx + t.inverse[1] * dy;
+            const double l2 = t.inverse[2] * dx + t.inverse[3] * dy;
+            const double l0 = 1.0 - l1 - l2;
+            if (l0 >= -TOLERANCE && l1 >= -TOLERANCE && l2 >= -TOLERANCE)
+            {
+                weights[0] = l0;
+                weights[1] = l1;
+                weights[2] = l2;
+                return t.element;
+            }
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,61 @@
+#ifndef TRIANGLE_BVH_HPP
+#define TRIANGLE_BVH_HPP
+
+#include <vector>
+
+#include "element.hpp"
+
+/// @brief Bounding volume hierarchy over triangles for point location
+/// @details Binary tree of axis-aligned boxes built by median splits of triangle centroids along the
+///          longest axis, leaves hold a few triangles. Nodes keep boxes of their children, so only nodes
+///          containing the point are fetched, and triangles are copied in leaf order with precomputed
+///          inverse affine maps, so a query touches contiguous memory. Queries are read-only and can run
+///          concurrently.
+class TriangleBvh
+{
+public:
+    TriangleBvh();
+
+    /// @brief Builds the hierarchy from triangles of elements (first three nodes)
+    /// @details Node coordinates are copied, so the hierarchy must be rebuilt if the mesh is changed
+    void build(const std::vector<Element*> &elements);
+
+    /// @brief Finds the triangle containing the point
+    /// @param weights barycentric coordinates of the point in the found triangle (linear shape functions)
+    /// @return index of the element or -1 if the point is outside of the mesh
+    int find(double x, double y, double weights[3]) const;
+
+    int getNodesCount() const { return nodes.size(); }
+    int getDepth() const { return depth; }
+
+protected:
+    /// @brief Inner node with boxes of both children, so a child is visited only if it contains the point
+    struct BvhNode
+    {
+        double boxes[2][4];     ///< xmin, ymin, xmax, ymax of children
+        int children[2];        ///< inner node index, or -1 - first triangle for leaves
+        int counts[2];          ///< triangles count of leaf children
+    };
+
+    struct Triangle
+    {
+        double x0, y0;      ///< first vertex
+        double inverse[4];  ///< maps (x - x0, y - y0) to the second and the third barycentric coordinates
+        int element;
+    };
+
+    /// @brief Builds the subtree of triangles [begin, end) and returns its box
+    /// @return child reference as in BvhNode::children
+    int buildNode(std::vector<int> &order, const std::vector<double> &centroids, int begin, int end, int level, double box[4]);
+
+private:
+    std::vector<BvhNode> nodes;
+    int root;                           ///< child reference to the root, see BvhNode::children
+    int rootCount;
+    double rootBox[4];
+    std::vector<Triangle> triangles;    ///< in leaf order
+    std::vector<double> boxes;          ///< box of each triangle in leaf order
+    int depth;
+};
+
+#endif /* TRIANGLE_BVH_HPP */
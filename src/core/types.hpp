@@ -0,0 +1,21 @@
+#ifndef TYPES_HPP
+#define TYPES_HPP
+
+#include <cstdint>
+
+#include <Eigen/Sparse>
+
+/// @brief Integer type of node ids, DOF indices and sparse matrix storage indices
+/// @details 32-bit by default, which keeps index arrays small and cache friendly. The FEM_INDEX_64
+///          CMake option selects 64-bit indices for models with more than 2^31 matrix entries.
+#ifdef FEM_INDEX_64
+typedef int64_t Index;
+#else
+typedef int32_t Index;
+#endif
+
+typedef Eigen::Triplet<double, Index> Triplet;
+typedef Eigen::SparseMatrix<double, Eigen::ColMajor, Index> SparseMatrix;
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor, Index> RowMajorMatrix;
+
+#endif /* TYPES_HPP */
@@ -1,34 +1,199 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
 
 
+#include "adaptiveSolver.hpp"
+#include "batchRunner.hpp"
+#include "contourRenderer.hpp"
+#include "explicitSolver.hpp"
+#include "modalSolver.hpp"
+#include "parallel.hpp"
+#include "server.hpp"
 #include "solver.hpp"
+#include "taskGraph.hpp"
+#include "threadPool.hpp"
 
 
 
 int main(int argc, char * argv[])
 {
-    if (argc == 1)
+    // Options start with "--", the rest are positional arguments
+    std::vector<std::string> args;
+    Solver::Backend backend = Solver::LDLT;
+    double targetError = 0.0;
+    int maxIterations = 10;
+    std::string probeFilename;
+    std::string renderDirectory;
+    std::string checkpointDirectory;
+    std::string manifestFilename;
+    size_t memoryBudget = 0;
+    double endTime = 0.0;
+    double snapshotInterval = 0.0;
+    double density = 7850.0;
+    int modesCount = 0;
+    ModalSolver::MassType massType = ModalSolver::CONSISTENT;
+    bool isServer = false;
+    bool isTimings = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.find("--backend=") == 0)
+        {
+            const std::string name = arg.substr(10);
+            try
+            {
+                backend = Solver::getBackendByName(name);
+            }
+            catch (...)
+            {
+                std::cout << "Error: Unknown backend " << name << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.find("--adaptive=") == 0)
+        {
+            targetError = std::stod(arg.substr(11));
+        }
+        else if (arg.find("--max-iterations=") == 0)
+        {
+            maxIterations = std::stoi(arg.substr(17));
+        }
+        else if (arg.find("--explicit=") == 0)
+        {
+            endTime = std::stod(arg.substr(11));
+        }
+        else if (arg.find("--snapshot-interval=") == 0)
+        {
+            snapshotInterval = std::stod(arg.substr(20));
+        }
+        else if (arg.find("--modes=") == 0)
+        {
+            modesCount = std::stoi(arg.substr(8));
+        }
+        else if (arg == "--lumped-mass")
+        {
+            massType = ModalSolver::LUMPED;
+        }
+        else if (arg.find("--density=") == 0)
+        {
+            density = std::stod(arg.substr(10));
+        }
+        else if (arg.find("--render=") == 0)
+        {
+            renderDirectory = arg.substr(9);
+        }
+        else if (arg.find("--checkpoint=") == 0)
+        {
+            checkpointDirectory = arg.substr(13);
+        }
+        else if (arg.find("--batch=") == 0)
+        {
+            manifestFilename = arg.substr(8);
+        }
+        else if (arg.find("--memory-budget=") == 0)
+        {
+            memoryBudget = std::stoull(arg.substr(16)) << 20;
+        }
+        else if (arg.find("--probe=") == 0)
+        {
+            probeFilename = arg.substr(8);
+        }
+        else if (arg == "--timings")
+        {
+            isTimings = true;
+        }
+        else if (arg == "--server")
+        {
+            isServer = true;
+        }
+        else if (arg.find("--threads=") == 0)
+        {
+            setThreadsCount(std::stoi(arg.substr(10)));
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+    if (!checkpointDirectory.empty() && backend != Solver::SUPERNODAL)
+    {
+        // Only supernodal factorizations are saved
+        std::cout << "Error: --checkpoint requires --backend=supernodal" << std::endl;
+        return 1;
+    }
+    if (!checkpointDirectory.empty() && !manifestFilename.empty())
+    {
+        // Concurrent jobs of the same problem would write the same checkpoint
+        std::cout << "Error: --checkpoint can't be used with --batch" << std::endl;
+        return 1;
+    }
+
+    if (isServer)
+    {
+        // Material may still be given positionally, the mesh comes with LOAD requests
+        Server server(args.size() > 1 ? std::stod(args[1]) : 0.3, args.size() > 2 ? std::stod(args[2]) : 2.e11, backend);
+        server.setCheckpointDirectory(checkpointDirectory);
+        if (!args.empty())
+            server.handle("LOAD " + args[0], std::cin, std::cout);
+        server.run(std::cin, std::cout);
+        return 0;
+    }
+
+    if (!manifestFilename.empty())
+    {
+        // Positional arguments are the material defaults of the manifest lines
+        const BatchRunner::Job defaults = {"", args.size() > 0 ? std::stod(args[0]) : 0.3, args.size() > 1 ? std::stod(args[1]) : 2.e11, backend};
+        try
+        {
+            const std::vector<BatchRunner::Job> jobs = BatchRunner::loadManifest(manifestFilename, defaults);
+            const auto start = std::chrono::steady_clock::now();
+            ThreadPool pool(getThreadsCount());
+            BatchRunner runner(pool, memoryBudget);
+            const std::vector<BatchRunner::Summary> summaries = runner.run(jobs, std::cout);
+
+            const int failed = std::count_if(summaries.begin(), summaries.end(), [](const BatchRunner::Summary &summary) { return !summary.error.empty(); });
+            std::cout << jobs.size() << " jobs, " << failed << " failed, " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                      << " s, peak estimated memory " << (runner.getPeakMemory() >> 20) << " of " << (runner.getMemoryBudget() >> 20) << " MB" << std::endl;
+            return failed > 0 ? 1 : 0;
+        }
+        catch (const char *message)
+        {
+            std::cout << "Error: " << message << std::endl;
+            return 1;
+        }
+    }
+
+    if (args.empty())
     {
         std::cout << "Error: Mesh file not set";
         return 1;
     }
     double poissonRatio = 0.3;
     double youngModulus = 2.e11;
-    if (argc > 2)
+    if (args.size() > 1)
     {
-        poissonRatio = std::stod(argv[2]);
+        poissonRatio = std::stod(args[1]);
     }
-    if (argc > 3)
+    if (args.size() > 2)
     {   
 
-        youngModulus = std::stod(argv[3]);
+        youngModulus = std::stod(args[2]);
     }
 
     Solver solver(poissonRatio, youngModulus);
-    std::cout << "Loading mesh from " << argv[1] << " ..." << std::endl;
+    solver.setBackend(backend);
+    solver.setCheckpointDirectory(checkpointDirectory);
+    std::cout << "Loading mesh from " << args[0] << " ..." << std::endl;
     try
     {
-        solver.loadGeometry(argv[1]);
+        solver.loadGeometry(args[0]);
     }
     catch (...)
     {
@@ -36,29 +201,166 @@ int main(int argc, char * argv[])
         return 1;
     }
     
+    if (endTime > 0.0)
+    {
+        // Transient response to the load applied at time 0, no stiffness matrix is assembled
+        try
+        {
+            solver.applyForces();
+            ExplicitSolver dynamics(solver.getGeometry(), solver.getElasticityMatrix(), density);
+            dynamics.setLoad(solver.getLoadVector());
+            std::cout << "Explicit integration, time step " << dynamics.getTimeStep() << " ..." << std::endl;
+            const int steps = dynamics.run(endTime, snapshotInterval);
+            std::cout << steps << " steps done" << std::endl;
+            dynamics.save("result.txt");
+        }
+        catch (const char *message)
+        {
+            std::cout << "Error: " << message << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (modesCount > 0)
+    {
+        // Natural frequencies and mode shapes instead of the static solution
+        try
+        {
+            std::cout << "Stiffness matrix calculation ..." << std::endl;
+            solver.calcuateStiffnessMatrix();
+            solver.applyConstraints();
+            std::cout << "Modal analysis ..." << std::endl;
+            ModalSolver modal(solver, density, massType);
+            modal.solve(modesCount);
 
-    std::cout << "Stiffness matrix calculation ..." << std::endl;
-    solver.calcuateStiffnessMatrix();
+            std::cout << "Mode\tFrequency, Hz" << std::endl;
+            for (int i = 0; i < modesCount; ++i)
+            {
+                std::cout << i + 1 << "\t" << modal.getFrequencies()(i) << std::endl;
+                modal.saveMode("mode_" + std::to_string(i + 1) + ".txt", i);
+            }
+        }
+        catch (const char *message)
+        {
+            std::cout << "Error: " << message << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
+    std::mutex logMutex;
+    auto log = [&logMutex](const std::string &message)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cout << message << std::endl;
+    };
 
-    std::cout << "Applying loads ..." << std::endl;;
-    solver.applyLoad();
+    // The run is a dependency graph: independent stages overlap, files are written while computing
+    TaskGraph graph;
+    int solved;
+    if (targetError > 0.0)
+    {
+        solved = graph.add("adaptive", [&]
+        {
+            log("Adaptive solving ...");
+            AdaptiveSolver adaptive(solver, targetError);
+            std::ostringstream table;
+            table << "DOFs\tElements\tError\tS";
+            for (auto &step: adaptive.run(maxIterations))
+                table << "\n" << step.dofs << "\t" << step.elements << "\t" << step.relativeError << "\t" << step.maxStress;
+            log(table.str());
+        });
+        graph.add("save mesh", [&] { solver.getGeometry().saveToFile("mesh_adapted.k"); }, {solved});
+    }
+    else
+    {
+        const int stiffness = graph.add("stiffness", [&]
+        {
+            log("Stiffness matrix calculation ...");
+            solver.calcuateStiffnessMatrix();
+        });
+        const int forces = graph.add("forces", [&]
+        {
+            log("Applying loads ...");
+            solver.applyForces();
+        });
+        const int constraints = graph.add("constraints", [&] { solver.applyConstraints(); }, {stiffness});
+        const int analysis = graph.add("analysis", [&] { solver.analyzePattern(); }, {constraints});
+        const int factorization = graph.add("factorization", [&]
+        {
+            log(solver.isCheckpointLoaded() ? "Solving with checkpoint factorization ..." : "Solving ...");
+            solver.factorize();
+        }, {analysis});
+        solved = graph.add("solve", [&] { solver.solve(); }, {factorization, forces});
+    }
 
-  
-    std::cout << "Solving ..." << std::endl;
-    solver.solve();
+    std::vector<std::vector<double>> stress;
+    graph.add("save displacements", [&] { solver.save("result.txt"); }, {solved});
+    const int stresses = graph.add("stress", [&] { stress = solver.calculateStress(); }, {solved});
+    graph.add("max stress", [&]
+    {
+        auto max_stress = std::max_element(stress.begin(), stress.end(), 
+                                           [](const std::vector<double> & first, const std::vector<double> & second) { return (first[3] < second[3]); });
 
-    auto stress = solver.calculateStress();
-    auto max_stress = std::max_element(stress.begin(), stress.end(), 
-                                       [](const std::vector<double> & first, const std::vector<double> & second) { return (first[3] < second[3]); });
+        std::ostringstream message;
+        message << "Max stresses: " << std::endl;
+        message << "Sx\tSy\tSxz\tS\t" <<std::endl;
+        message << (*max_stress)[0] << "\t" << (*max_stress)[1] << "\t" << (*max_stress)[2] << "\t" << (*max_stress)[3];
+        log(message.str());
+    }, {stresses});
+    graph.add("save stress", [&] { solver.saveSigma("stress.txt", stress); }, {stresses});
+    if (!renderDirectory.empty())
+    {
+        graph.add("render", [&]
+        {
+            ContourRenderer().renderStress(solver.getGeometry(), stress, solver.getDisplacements(), renderDirectory);
+            log("Images are saved to " + renderDirectory);
+        }, {stresses});
+    }
 
+    std::vector<Eigen::Vector2d> points;
+    if (!probeFilename.empty())
+    {
+        const int read = graph.add("read points", [&]
+        {
+            std::ifstream input(probeFilename);
+            if (!input.is_open())
+                throw "Probe file not found";
+            double x, y;
+            while (input >> x >> y)
+                points.push_back(Eigen::Vector2d(x, y));
+        });
+        graph.add("probe", [&]
+        {
+            auto probes = solver.probe(points);
+            std::ofstream output("probe.txt");
+            output << "x\ty\tUx\tUy\tSx\tSy\tSxy\tS" << std::endl;
+            for (int i = 0; i < points.size(); ++i)
+                output << points[i](0) << " " << points[i](1) << " " << probes[i].ux << " " << probes[i].uy << " "
+                       << probes[i].sx << " " << probes[i].sy << " " << probes[i].sxy << " " << probes[i].s << std::endl;
+            log("Probed " + std::to_string(points.size()) + " points to probe.txt");
+        }, {read, solved});
+    }
 
-    std::cout << "Max stresses: " << std::endl;
-    std::cout << "Sx\tSy\tSxz\tS\t" <<std::endl;
-    std::cout << (*max_stress)[0] << "\t" << (*max_stress)[1] << "\t" << (*max_stress)[2] << "\t" << (*max_stress)[3]<< std::endl;
+    // At least two workers, so writing files overlaps with compute even on a single core
+    ThreadPool pool(std::max(2, getThreadsCount()));
+    try
+    {
+        graph.run(pool);
+    }
+    catch (const char *message)
+    {
+        std::cout << "Error: " << message << std::endl;
+        return 1;
+    }
 
-    solver.save("result.txt");
-    solver.saveSigma("stress.txt");
+    if (isTimings)
+    {
+        std::cout << "Task\tStart, s\tFinish, s" << std::endl;
+        for (auto &task: graph.getTasks())
+            std::cout << task.name << "\t" << task.start << "\t" << task.finish << std::endl;
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "geometry.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+namespace py = pybind11;
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor> StressMatrix;
+typedef Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor> ProbeMatrix;
+
+/// @brief Read-only array viewing memory of the owner, which is kept alive by the array
+/// @details Solver state is changed by its methods only, e.g. set_load, so writes to views raise
+template <typename Scalar>
+static py::array_t<Scalar> view(const Scalar *data, std::vector<py::ssize_t> shape, std::vector<py::ssize_t> strides, py::handle owner)
+{
+    py::array_t<Scalar> result(shape, strides, data, owner);
+    result.attr("setflags")(py::arg("write") = false);
+    return result;
+}
+
+/// @brief Array taking a buffer computed in C++, the buffer is moved instead of copied
+template <typename Container, typename Scalar>
+static py::array_t<Scalar> take(Container *container, const Scalar *data, std::vector<py::ssize_t> shape)
+{
+    py::capsule owner(container, [](void *pointer) { delete static_cast<Container*>(pointer); });
+    return py::array_t<Scalar>(shape, data, owner);
+}
+
+/// @brief Node coordinates as (n, 2) array viewing x and y fields of Node structures
+static py::array_t<double> nodesView(py::object self)
+{
+    auto &nodes = self.cast<Geometry&>().getNodes();
+    static const Node empty(0.0, 0.0, 0);
+    return view(nodes.empty() ? &empty.x : &nodes[0].x, {static_cast<py::ssize_t>(nodes.size()), 2},
+                {sizeof(Node), sizeof(double)}, self);
+}
+
+/// @brief Shifted node ids, they number DOFs
+static py::array_t<Index> nodeIdsView(py::object self)
+{
+    auto &nodes = self.cast<Geometry&>().getNodes();
+    static const Node empty(0.0, 0.0, 0);
+    return view(nodes.empty() ? &empty.id : &nodes[0].id, {static_cast<py::ssize_t>(nodes.size())}, {sizeof(Node)}, self);
+}
+
+static py::array_t<Index> connectivity(Geometry &geometry)
+{
+    auto *result = new std::vector<Index>(geometry.getConnectivity());
+    return take(result, result->data(), {static_cast<py::ssize_t>(result->size() / 3), 3});
+}
+
+PYBIND11_MODULE(fem, m)
+{
+    m.doc() = "Plane stress finite element solver. Arrays of nodes and results view solver memory without copying, "
+              "they are invalidated by load, refine and the next solve.";
+
+    // Core reports errors with string exceptions
+    py::register_exception_translator([](std::exception_ptr error)
+    {
+        try
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+        catch (const char *message)
+        {
+            PyErr_SetString(PyExc_RuntimeError, message);
+        }
+    });
+
+    m.def("set_threads_count", &setThreadsCount, py::arg("count"));
+    m.def("get_threads_count", &getThreadsCount);
+
+    py::class_<Geometry>(m, "Geometry")
+        .def(py::init<>())
+        .def("load", &Geometry::loadFromFile, py::arg("filename"))
+        .def("save", &Geometry::saveToFile, py::arg("filename"))
+        .def("refine", &Geometry::refine, py::arg("marked_elements"))
+        .def_property_readonly("nodes", &nodesView, "(nodes, 2) coordinates, a view")
+        .def_property_readonly("node_ids", &nodeIdsView, "Node ids numbering DOFs and rows of displacements, a view")
+        .def_property_readonly("elements", &connectivity, "(elements, 3) node positions in nodes")
+        .def_property_readonly("shift", &Geometry::getShift, "Subtracted from node ids of the file");
+
+    py::enum_<Solver::Backend>(m, "Backend")
+        .value("LDLT", Solver::LDLT)
+        .value("DOMAIN_DECOMPOSITION", Solver::DOMAIN_DECOMPOSITION)
+        .value("SUPERNODAL", Solver::SUPERNODAL)
+        .value("AMG", Solver::AMG);
+
+    py::class_<Solver>(m, "Solver")
+        .def(py::init<double, double>(), py::arg("poisson_ratio") = 0.3, py::arg("young_modulus") = 2.e11)
+        .def(py::init<const std::string&, double, double>(),
+             py::arg("filename"), py::arg("poisson_ratio") = 0.3, py::arg("young_modulus") = 2.e11)
+        .def("load", &Solver::loadGeometry, py::arg("filename"))
+        .def("refine", &Solver::refine, py::arg("marked_elements"))
+        .def("set_material", &Solver::setMaterial, py::arg("poisson_ratio"), py::arg("young_modulus"))
+        .def("set_backend", &Solver::setBackend, py::arg("backend"))
+        .def("set_load", &Solver::setLoadVector, py::arg("load"))
+        .def("assemble", [](Solver &self)
+             {
+                 self.calcuateStiffnessMatrix();
+                 self.applyLoad();
+             }, py::call_guard<py::gil_scoped_release>(),
+             "Assembles stiffness matrix and load vector from boundary conditions of the mesh")
+        .def("solve", &Solver::solve, py::call_guard<py::gil_scoped_release>(),
+             "Solves the assembled system, the factorization is reused by later calls")
+        .def("calculate_stress", [](Solver &self)
+             {
+                 auto *stress = new StressMatrix();
+                 {
+                     py::gil_scoped_release release;
+                     try
+                     {
+                         self.calculateStress(*stress);
+                     }
+                     catch (...)
+                     {
+                         delete stress;
+                         throw;
+                     }
+                 }
+                 return take(stress, stress->data(), {static_cast<py::ssize_t>(stress->rows()), 4});
+             }, "(elements, 4) Sx, Sy, Sxy and von Mises stress, computed by getThreadsCount() threads")
+        .def("probe", [](Solver &self, py::array_t<double, py::array::c_style | py::array::forcecast> points)
+             {
+                 if (points.ndim() != 2 || points.shape(1) != 2)
+                     throw std::invalid_argument("Points must be an (n, 2) array");
+
+                 auto coordinates = points.unchecked<2>();
+                 std::vector<Eigen::Vector2d> query(points.shape(0));
+                 for (py::ssize_t i = 0; i < points.shape(0); ++i)
+                     query[i] = Eigen::Vector2d(coordinates(i, 0), coordinates(i, 1));
+
+                 std::vector<ProbeResult> probes;
+                 {
+                     py::gil_scoped_release release;
+                     probes = self.probe(query);
+                 }
+
+                 auto *table = new ProbeMatrix(probes.size(), 6);
+                 for (size_t i = 0; i < probes.size(); ++i)
+                     table->row(i) << probes[i].ux, probes[i].uy, probes[i].sx, probes[i].sy, probes[i].sxy, probes[i].s;
+                 return take(table, table->data(), {static_cast<py::ssize_t>(table->rows()), 6});
+             }, py::arg("points"), "(points, 6) Ux, Uy, Sx, Sy, Sxy and von Mises stress, NaN out of the mesh")
+        .def("save", &Solver::save, py::arg("filename"))
+        .def_property_readonly("geometry", &Solver::getGeometry, py::return_value_policy::reference_internal)
+        .def_property_readonly("displacements", [](py::object self)
+             {
+                 const auto &u = self.cast<Solver&>().getDisplacements();
+                 return view(u.data(), {static_cast<py::ssize_t>(u.size() / 2), 2}, {2 * sizeof(double), sizeof(double)}, self);
+             }, "(nodes, 2) displacements indexed by node id, a view, empty before solve")
+        .def_property_readonly("load_vector", [](py::object self)
+             {
+                 const auto &F = self.cast<Solver&>().getLoadVector();
+                 return view(F.data(), {static_cast<py::ssize_t>(F.size())}, {sizeof(double)}, self);
+             }, "Load vector, a view")
+        .def_property_readonly("poisson_ratio", &Solver::getPoissonRatio)
+        .def_property_readonly("young_modulus", &Solver::getYoungModulus);
+}
@@ -0,0 +1,46 @@
+import os
+import unittest
+
+import numpy as np
+
+import fem
+
+MESH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "data", "mesh_coarse.k")
+
+
+class SolverTest(unittest.TestCase):
+    def setUp(self):
+        self.solver = fem.Solver(MESH, 0.3, 2.e11)
+        self.solver.assemble()
+        self.solver.solve()
+
+    def test_solve(self):
+        geometry = self.solver.geometry
+        self.assertEqual(geometry.nodes.shape, (28, 2))
+        self.assertEqual(geometry.elements.shape, (38, 3))
+        u = self.solver.displacements[geometry.node_ids]
+        self.assertEqual(u.shape, (28, 2))
+        self.assertGreater(np.abs(u).max(), 0.0)
+        self.assertEqual(self.solver.calculate_stress().shape, (38, 4))
+
+    def test_probe(self):
+        geometry = self.solver.geometry
+        u = self.solver.displacements[geometry.node_ids]
+        probes = self.solver.probe(np.array([geometry.nodes[3], [10.0, 10.0]]))
+        self.assertEqual(probes.shape, (2, 6))
+        np.testing.assert_allclose(probes[0, :2], u[3], rtol=1.e-9, atol=1.e-20)
+        self.assertTrue(np.isnan(probes[1]).all())
+
+    def test_views_are_read_only(self):
+        for array in (self.solver.geometry.nodes, self.solver.geometry.node_ids,
+                      self.solver.displacements, self.solver.load_vector):
+            with self.assertRaises(ValueError):
+                array[0] = 1
+
+    def test_errors(self):
+        with self.assertRaises(RuntimeError):
+            fem.Solver("missing.k")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "amgSolver.hpp"
+#include "solver.hpp"
+
+
+TEST(AmgSolver, MatchesLDLT)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.refine(std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+                                   19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37});
+    solver.refine(std::vector<int>(1, 0));
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    solver.solve();
+    Eigen::VectorX<double> expected = solver.getDisplacements();
+
+    solver.setBackend(Solver::AMG);
+    solver.solve();
+
+    EXPECT_LT((solver.getDisplacements() - expected).norm(), 1.e-8 * expected.norm());
+}
+
+TEST(AmgSolver, Hierarchy)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    for (int i = 0; i < 4; ++i)
+    {
+        std::vector<int> all(solver.getGeometry().getElements().size());
+        for (int j = 0; j < all.size(); ++j)
+            all[j] = j;
+        solver.refine(all);
+    }
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    AmgSolver amg(solver.getGeometry());
+    amg.compute(solver.getMatrix());
+
+    EXPECT_GE(amg.getPreconditioner().getLevelsCount(), 2);
+    EXPECT_LT(amg.getPreconditioner().getComplexity(), 2.0);
+
+    Eigen::VectorX<double> x = amg.solve(solver.getLoadVector());
+    EXPECT_LT((solver.getMatrix().selfadjointView<Eigen::Upper>() * x - solver.getLoadVector()).norm(), 1.e-9 * solver.getLoadVector().norm());
+    EXPECT_LT(amg.getIterations(), 60);
+
+    // Hierarchy is reused for another load case
+    Eigen::VectorX<double> load = 2.0 * solver.getLoadVector();
+    Eigen::VectorX<double> y = amg.solve(load);
+    EXPECT_LT((y - 2.0 * x).norm(), 1.e-8 * y.norm());
+}
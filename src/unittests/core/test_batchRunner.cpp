@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "batchRunner.hpp"
+
+
+static const BatchRunner::Job DEFAULTS = {"", 0.3, 2.e11, Solver::LDLT};
+
+TEST(BatchRunner, LoadManifest)
+{
+    const std::string filename = "manifest_test.txt";
+    {
+        std::ofstream output(filename);
+        output << "# mesh poisson young backend" << std::endl;
+        output << "data/mesh_coarse.k" << std::endl;
+        output << std::endl;
+        output << "data/mesh_simple.k 0.25 7e10" << std::endl;
+        output << "data/mesh_coarse.k 0.2 1e11 supernodal" << std::endl;
+    }
+    auto jobs = BatchRunner::loadManifest(filename, DEFAULTS);
+
+    ASSERT_EQ(jobs.size(), 3);
+    EXPECT_EQ(jobs[0].mesh, "data/mesh_coarse.k");
+    EXPECT_EQ(jobs[0].poissonRatio, 0.3);
+    EXPECT_EQ(jobs[0].backend, Solver::LDLT);
+    EXPECT_EQ(jobs[1].mesh, "data/mesh_simple.k");
+    EXPECT_EQ(jobs[1].youngModulus, 7.e10);
+    EXPECT_EQ(jobs[2].poissonRatio, 0.2);
+    EXPECT_EQ(jobs[2].backend, Solver::SUPERNODAL);
+
+    {
+        std::ofstream output(filename);
+        output << "data/mesh_coarse.k 0.3" << std::endl;
+    }
+    EXPECT_ANY_THROW(BatchRunner::loadManifest(filename, DEFAULTS));
+    std::remove(filename.c_str());
+    EXPECT_ANY_THROW(BatchRunner::loadManifest(filename, DEFAULTS));
+}
+
+TEST(BatchRunner, Run)
+{
+    // Reference of a single run as fem_demo does it
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyForces();
+    solver.applyConstraints();
+    solver.factorize();
+    solver.solve();
+    const auto stress = solver.calculateStress();
+    const double maxStress = (*std::max_element(stress.begin(), stress.end(),
+                                                [](const std::vector<double> &first, const std::vector<double> &second) { return first[3] < second[3]; }))[3];
+
+    std::vector<BatchRunner::Job> jobs;
+    for (int i = 0; i < 6; ++i)
+    {
+        BatchRunner::Job job = DEFAULTS;
+        job.mesh = "data/mesh_coarse.k";
+        job.backend = i % 2 ? Solver::SUPERNODAL : Solver::LDLT;
+        jobs.push_back(job);
+    }
+    jobs.push_back(DEFAULTS);
+    jobs.back().mesh = "data/missing.k";
+
+    // Room for two jobs at once
+    const size_t memory = BatchRunner::estimateMemory(jobs[0]);
+    ASSERT_GT(memory, 0);
+    ThreadPool pool(3);
+    BatchRunner runner(pool, 2 * memory + memory / 2);
+    std::ostringstream output;
+    auto summaries = runner.run(jobs, output);
+
+    EXPECT_GE(runner.getPeakMemory(), memory);
+    EXPECT_LE(runner.getPeakMemory(), 2 * memory);
+    ASSERT_EQ(summaries.size(), jobs.size());
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(summaries[i].index, i);
+        EXPECT_TRUE(summaries[i].error.empty());
+        EXPECT_EQ(summaries[i].dofs, solver.getMatrix().rows());
+        ASSERT_EQ(summaries[i].maxStress.size(), 4);
+        EXPECT_NEAR(summaries[i].maxStress[3], maxStress, 1.e-9 * maxStress);
+    }
+    EXPECT_EQ(summaries.back().error, "File not found");
+
+    // Header and a line per job
+    std::istringstream lines(output.str());
+    std::string line;
+    int count = 0;
+    while (std::getline(lines, line))
+        ++count;
+    EXPECT_EQ(count, jobs.size() + 1);
+    EXPECT_NE(output.str().find("6\tdata/missing.k\tError: File not found"), std::string::npos);
+
+    // A job above the whole budget still runs, alone
+    BatchRunner small(pool, memory / 2);
+    summaries = small.run({jobs[0]}, output);
+    EXPECT_TRUE(summaries[0].error.empty());
+    EXPECT_EQ(small.getPeakMemory(), memory / 2);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "contourRenderer.hpp"
+#include "solver.hpp"
+
+
+/// @brief Unit square of two triangles split by the diagonal from (0, 0) to (1, 1)
+static void unitSquare(std::vector<Eigen::Vector2d> &points, std::vector<Index> &connectivity)
+{
+    points = {Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(1.0, 0.0), Eigen::Vector2d(1.0, 1.0), Eigen::Vector2d(0.0, 1.0)};
+    connectivity = {0, 1, 2, 0, 2, 3};
+}
+
+static const unsigned char* pixel(const Image &image, int x, int y)
+{
+    return &image.pixels[3 * (y * image.width + x)];
+}
+
+TEST(ContourRenderer, ElementField)
+{
+    std::vector<Eigen::Vector2d> points;
+    std::vector<Index> connectivity;
+    unitSquare(points, connectivity);
+
+    Field field;
+    field.name = "S";
+    field.values = {0.0, 1.0};
+
+    ContourRenderer renderer(100, 100);
+    renderer.setGridOverlay(false);
+    auto images = renderer.render(points, connectivity, {field});
+    ASSERT_EQ(images.size(), 2);
+
+    // The lower right triangle has the minimum (blue), the upper left one the maximum (red)
+    const unsigned char *lowerRight = pixel(images[1], 80, 80);
+    EXPECT_EQ(lowerRight[0], 0);
+    EXPECT_EQ(lowerRight[2], 255);
+    const unsigned char *upperLeft = pixel(images[1], 20, 20);
+    EXPECT_EQ(upperLeft[0], 255);
+    EXPECT_EQ(upperLeft[2], 0);
+
+    // Margins are empty, the grid is drawn along the boundary and the diagonal only
+    EXPECT_EQ(pixel(images[1], 2, 50)[0] + pixel(images[1], 2, 50)[1] + pixel(images[1], 2, 50)[2], 0);
+    EXPECT_EQ(pixel(images[0], 50, 49)[0], 255);
+    EXPECT_EQ(pixel(images[0], 30, 60)[0], 0);
+    EXPECT_EQ(pixel(images[0], 5, 50)[0], 255);
+}
+
+TEST(ContourRenderer, NodalFieldIsInterpolated)
+{
+    std::vector<Eigen::Vector2d> points;
+    std::vector<Index> connectivity;
+    unitSquare(points, connectivity);
+
+    // Linear in x, so the color changes along x only
+    Field field;
+    field.name = "Sx_nodal";
+    field.values = {0.0, 1.0, 1.0, 0.0};
+    field.isNodal = true;
+
+    ContourRenderer renderer(100, 100);
+    renderer.setGridOverlay(false);
+    auto images = renderer.render(points, connectivity, {field});
+
+    for (int c = 0; c < 3; ++c)
+    {
+        EXPECT_EQ(pixel(images[1], 30, 20)[c], pixel(images[1], 30, 80)[c]);
+    }
+    EXPECT_GT(pixel(images[1], 90, 50)[0], pixel(images[1], 10, 50)[0]);
+    EXPECT_LT(pixel(images[1], 90, 50)[2], pixel(images[1], 10, 50)[2]);
+
+    EXPECT_THROW(renderer.render(points, connectivity, {Field{"wrong", {1.0}, true}}), const char*);
+}
+
+TEST(ContourRenderer, Smooth)
+{
+    std::vector<Eigen::Vector2d> points;
+    std::vector<Index> connectivity;
+    unitSquare(points, connectivity);
+    points.push_back(Eigen::Vector2d(5.0, 5.0));
+
+    auto values = ContourRenderer::smooth(points, connectivity, {1.0, 3.0});
+    EXPECT_DOUBLE_EQ(values[0], 2.0);
+    EXPECT_DOUBLE_EQ(values[1], 1.0);
+    EXPECT_DOUBLE_EQ(values[2], 2.0);
+    EXPECT_DOUBLE_EQ(values[3], 3.0);
+    EXPECT_TRUE(std::isnan(values[4]));
+}
+
+TEST(ContourRenderer, SavePng)
+{
+    Image image;
+    image.width = 300;
+    image.height = 200;
+    image.pixels.assign(3 * image.width * image.height, 7);
+    ContourRenderer::savePng("test_image.png", image);
+
+    std::ifstream input("test_image.png", std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    std::remove("test_image.png");
+
+    const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    ASSERT_GT(data.size(), 33);
+    EXPECT_TRUE(std::equal(signature, signature + 8, data.begin()));
+    EXPECT_EQ(std::string(data.begin() + 12, data.begin() + 16), "IHDR");
+    EXPECT_EQ((data[16] << 8) | data[17], 0);
+    EXPECT_EQ((data[18] << 8) | data[19], 300);
+    EXPECT_EQ((data[22] << 8) | data[23], 200);
+
+    // Stored blocks: signature, IHDR, IDAT with zlib header, block headers and Adler-32, IEND
+    const size_t raw = (3 * 300 + 1) * 200;
+    const size_t blocks = (raw + 65534) / 65535;
+    EXPECT_EQ(data.size(), 8 + 25 + 12 + 2 + 5 * blocks + raw + 4 + 12);
+}
+
+TEST(ContourRenderer, RenderStress)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    solver.solve();
+
+    ContourRenderer renderer(64, 64);
+    renderer.renderStress(solver.getGeometry(), solver.calculateStress(), solver.getDisplacements(), ".");
+
+    for (std::string name: {"grid", "Sx", "Sy", "Sxy", "S", "Sx_nodal", "Sy_nodal", "Sxy_nodal", "S_nodal"})
+    {
+        for (std::string suffix: {"", "_deformed"})
+        {
+            const std::string filename = name + suffix + ".png";
+            std::ifstream input(filename);
+            EXPECT_TRUE(input.is_open()) << filename;
+            input.close();
+            std::remove(filename.c_str());
+        }
+    }
+
+    EXPECT_THROW(renderer.renderStress(solver.getGeometry(), solver.calculateStress(), Eigen::VectorX<double>(), "absent/directory"),
+                 const char*);
+}
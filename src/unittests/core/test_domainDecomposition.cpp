@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "domainDecomposition.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+
+TEST(DomainDecomposition, Partition)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_coarse.k");
+
+    Solver solver("data/mesh_coarse.k");
+    solver.calcuateStiffnessMatrix();
+
+    DomainDecompositionSolver dd(geometry, 4);
+    dd.analyzePattern(solver.getMatrix());
+
+    auto parts = dd.getElementParts();
+    ASSERT_EQ(parts.size(), 38);
+
+    std::vector<int> sizes(4, 0);
+    for (int part: parts)
+        sizes[part]++;
+
+    for (int size: sizes)
+        EXPECT_GE(size, 9);
+
+    EXPECT_GT(dd.getInterfaceSize(), 0);
+    EXPECT_LT(dd.getInterfaceSize(), 56);
+}
+
+TEST(DomainDecomposition, MatchesMonolithic)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    solver.solve();
+    Eigen::VectorX<double> expected = solver.getDisplacements();
+
+    for (int threads: {1, 2, 3})
+    {
+        setThreadsCount(threads);
+        solver.setBackend(Solver::DOMAIN_DECOMPOSITION);
+        solver.solve();
+
+        auto result = solver.getDisplacements();
+        ASSERT_EQ(result.size(), expected.size());
+        EXPECT_LT((result - expected).norm(), 1.e-10 * expected.norm());
+    }
+}
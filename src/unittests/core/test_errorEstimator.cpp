@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "adaptiveSolver.hpp"
+#include "errorEstimator.hpp"
+#include "solver.hpp"
+
+
+TEST(ErrorEstimator, ConstantStressHasNoError)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+
+    auto &elements = solver.getGeometry().getElements();
+    std::vector<std::vector<double>> stresses(elements.size(), {1.e6, 2.e5, -3.e5});
+
+    ErrorEstimator estimator(solver.getGeometry(), solver.getElasticityMatrix());
+    auto errors = estimator.estimate(stresses);
+
+    ASSERT_EQ(errors.size(), elements.size());
+    for (double error: errors)
+        EXPECT_NEAR(error, 0.0, 1.e-12);
+    EXPECT_NEAR(estimator.getRelativeError(), 0.0, 1.e-12);
+    EXPECT_TRUE(estimator.mark(0.05).empty());
+
+    EXPECT_DOUBLE_EQ(estimator.getNodalStresses()[0](0), 1.e6);
+}
+
+TEST(ErrorEstimator, CoarseMesh)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    solver.solve();
+
+    ErrorEstimator estimator(solver.getGeometry(), solver.getElasticityMatrix());
+    estimator.estimate(solver.calculateStress());
+
+    EXPECT_GT(estimator.getRelativeError(), 0.0);
+    EXPECT_LT(estimator.getRelativeError(), 1.0);
+    EXPECT_FALSE(estimator.mark(0.01).empty());
+}
+
+TEST(AdaptiveSolver, ErrorDecreases)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+
+    AdaptiveSolver adaptive(solver, 0.01);
+    auto history = adaptive.run(3);
+
+    ASSERT_EQ(history.size(), 3);
+    EXPECT_GT(history[1].dofs, history[0].dofs);
+    EXPECT_LT(history[2].relativeError, history[0].relativeError);
+    EXPECT_EQ(solver.getDisplacements().size(), history[2].dofs);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+#include "explicitSolver.hpp"
+#include "parallel.hpp"
+#include "solver.hpp"
+
+
+TEST(ExplicitSolver, InternalForcesMatchStiffness)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    ExplicitSolver dynamics(solver.getGeometry(), solver.getElasticityMatrix(), 7850.0);
+
+    // Element coloring leaves no shared nodes within a color
+    EXPECT_GT(dynamics.getColorsCount(), 1);
+
+    Eigen::VectorX<double> u = Eigen::VectorX<double>::Random(solver.getMatrix().rows());
+    Eigen::VectorX<double> f;
+    dynamics.calculateInternalForces(u, f);
+
+    Eigen::VectorX<double> expected = solver.getMatrix().selfadjointView<Eigen::Upper>() * u;
+    EXPECT_LT((f - expected).norm(), 1.e-12 * expected.norm());
+}
+
+TEST(ExplicitSolver, MassAndTimeStep)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    const double density = 7850.0;
+    ExplicitSolver dynamics(solver.getGeometry(), solver.getElasticityMatrix(), density);
+
+    double area = 0.0;
+    double minAltitude = 1.e300;
+    for (auto element: solver.getGeometry().getElements())
+    {
+        area += element->getSquare();
+        double longest = 0.0;
+        for (int j = 0; j < 3; ++j)
+        {
+            const Node &a = element->getNode(j), &b = element->getNode((j + 1) % 3);
+            longest = std::max(longest, std::hypot(a.x - b.x, a.y - b.y));
+        }
+        minAltitude = std::min(minAltitude, 2.0 * element->getSquare() / longest);
+    }
+
+    // Each direction carries the whole mass
+    EXPECT_NEAR(dynamics.getMasses().sum(), 2.0 * density * area, 1.e-10 * density * area);
+
+    const double speed = std::sqrt(2.e11 / (1.0 - 0.3 * 0.3) / density);
+    EXPECT_NEAR(dynamics.getStableTimeStep(), 0.8 * minAltitude / speed, 1.e-12 * minAltitude / speed);
+}
+
+TEST(ExplicitSolver, DampedRunConvergesToStatic)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    solver.solve();
+    const Eigen::VectorX<double> expected = solver.getDisplacements();
+
+    const int threads = getThreadsCount();
+    setThreadsCount(2);
+
+    ExplicitSolver dynamics(solver.getGeometry(), solver.getElasticityMatrix(), 7850.0);
+    dynamics.setLoad(solver.getLoadVector());
+
+    // Close to critical damping of the lowest mode, estimated from the static solution by Rayleigh quotient
+    Eigen::VectorX<double> f;
+    dynamics.calculateInternalForces(expected, f);
+    const double omega = std::sqrt(expected.dot(f) / expected.dot(dynamics.getMasses().cwiseProduct(expected)));
+    dynamics.setDamping(2.0 * omega);
+
+    const double endTime = 40.0 / omega;
+    const int steps = dynamics.run(endTime, endTime / 4, "explicit_test");
+    setThreadsCount(threads);
+
+    EXPECT_GT(steps, 0);
+    EXPECT_NEAR(dynamics.getTime(), endTime, 1.e-9 * endTime);
+    EXPECT_LT((dynamics.getDisplacements() - expected).norm(), 1.e-3 * expected.norm());
+
+    // Snapshots at 0, 1/4, ..., 1 of the end time
+    for (int i = 0; i < 5; ++i)
+    {
+        char filename[32];
+        std::snprintf(filename, sizeof(filename), "explicit_test_%04d.txt", i);
+        std::ifstream input(filename);
+        ASSERT_TRUE(input.is_open()) << filename;
+        int lines = 0;
+        std::string line;
+        while (std::getline(input, line))
+            ++lines;
+        EXPECT_EQ(lines, solver.getGeometry().getNodes().size());
+        input.close();
+        std::remove(filename);
+    }
+}
+
+TEST(ExplicitSolver, SnapshotToMissingDirectory)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    ExplicitSolver dynamics(solver.getGeometry(), solver.getElasticityMatrix(), 7850.0);
+    dynamics.setLoad(solver.getLoadVector());
+
+    // Integration finishes, then the lost snapshots are reported
+    const double endTime = 10.0 * dynamics.getTimeStep();
+    EXPECT_ANY_THROW(dynamics.run(endTime, endTime / 2, "missing_directory/snapshot"));
+    EXPECT_NEAR(dynamics.getTime(), endTime, 1.e-9 * endTime);
+}
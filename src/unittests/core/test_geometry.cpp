@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <map>
+
 #include "geometry.hpp"
 
 
@@ -87,6 +90,21 @@ TEST(GeometryCoarseMesh, CheckElementsCount)
     EXPECT_EQ(elements.size(), 38);
 }
 
+TEST(GeometryCoarseMesh, Connectivity)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_coarse.k");
+
+    auto connectivity = geometry.getConnectivity();
+    auto &elements = geometry.getElements();
+    auto &nodes = geometry.getNodes();
+
+    ASSERT_EQ(connectivity.size(), 3 * elements.size());
+    for (int i = 0; i < elements.size(); ++i)
+        for (int j = 0; j < 3; ++j)
+            EXPECT_EQ(&nodes[connectivity[3 * i + j]], &elements[i]->getNode(j));
+}
+
 TEST(GeometryCoarseMesh, CheckSortedBoundaries)
 {
     Geometry geometry;
@@ -127,4 +145,118 @@ TEST(GeometryHomoMesh, CheckBoundaries)
     //   10            0.15       0.0601873               0       0       0
     //   11            0.15        0.123094               0       0       0
     //   12            0.15        0.186547               0       0       0
-    //    3            0.15            0.25               0       0       0
\ No newline at end of file
+    //    3            0.15            0.25               0       0       0
+TEST(GeometryRefinement, RefineSingleElement)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_simple.k");
+
+    geometry.refine({0});
+
+    auto &elements = geometry.getElements();
+    double square = 0.0;
+    for (auto element: elements)
+        square += element->getSquare();
+
+    EXPECT_DOUBLE_EQ(square, 0.09);
+    // Marked element split into four, its neighbour is bisected through the shared diagonal
+    EXPECT_EQ(elements.size(), 6);
+    EXPECT_EQ(geometry.getNodes().size(), 7);
+    EXPECT_EQ(geometry.getNodes().back().id, 6);
+}
+
+TEST(GeometryRefinement, Conforming)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_coarse.k");
+
+    geometry.refine({0, 5, 17});
+
+    // Every interior edge is shared by exactly two elements, boundary ones by a single element
+    std::map<std::pair<int, int>, int> edges;
+    for (auto element: geometry.getElements())
+        for (int j = 0; j < 3; ++j)
+        {
+            int a = element->getNode(j).id, b = element->getNode((j + 1) % 3).id;
+            edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+        }
+
+    int boundaryEdges = 0;
+    for (auto &edge: edges)
+    {
+        EXPECT_LE(edge.second, 2);
+        boundaryEdges += edge.second == 1;
+    }
+
+    double square = 0.0;
+    for (auto element: geometry.getElements())
+        square += element->getSquare();
+
+    Geometry original;
+    original.loadFromFile("data/mesh_coarse.k");
+    double originalSquare = 0.0;
+    for (auto element: original.getElements())
+        originalSquare += element->getSquare();
+
+    EXPECT_NEAR(square, originalSquare, 1.e-12);
+    EXPECT_GT(geometry.getElements().size(), 38 + 3 * 3);
+    EXPECT_GT(boundaryEdges, 0);
+}
+
+TEST(GeometryKeywords, NodeSets)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_coarse_keywords.k");
+
+    auto &sets = geometry.getNodeSets();
+    ASSERT_EQ(sets.size(), 3);
+    EXPECT_EQ(sets.at(1).type, NodeSet::LIST);
+    EXPECT_EQ(sets.at(2).type, NodeSet::BOX);
+    EXPECT_EQ(sets.at(3).type, NodeSet::SEGMENT);
+
+    // Sets select the same nodes as default boundaries
+    Geometry defaults;
+    defaults.loadFromFile("data/mesh_coarse.k");
+    for (int i = 0; i < 3; ++i)
+    {
+        std::vector<Index> expected;
+        for (auto &node: defaults.getBoundaries()[i].nodes)
+            expected.push_back(node.node);
+        std::vector<Index> found = sets.at(i + 1).nodes;
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+    }
+
+    auto &boundaries = geometry.getBoundaries();
+    ASSERT_EQ(boundaries.size(), 3);
+    EXPECT_EQ(boundaries[0].nodes[0].type, BoundaryNode::UX);
+    EXPECT_EQ(boundaries[1].nodes[0].type, BoundaryNode::UY);
+    EXPECT_EQ(boundaries[2].nodes[0].type, BoundaryNode::F);
+    EXPECT_DOUBLE_EQ(boundaries[2].fx, 1.e6);
+    EXPECT_DOUBLE_EQ(boundaries[2].fy, 0.0);
+    EXPECT_TRUE(boundaries[2].distributed);
+}
+
+TEST(GeometryKeywords, Refinement)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_coarse_keywords.k");
+
+    std::vector<int> counts;
+    for (int set = 1; set <= 3; ++set)
+        counts.push_back(geometry.getNodeSets().at(set).nodes.size());
+
+    std::vector<int> all(geometry.getElements().size());
+    for (int i = 0; i < all.size(); ++i)
+        all[i] = i;
+    geometry.refine(all);
+
+    // Lists get middles of edges between their nodes, regions are queried again, so every straight
+    // side gets a new node per edge
+    for (int set = 1; set <= 3; ++set)
+    {
+        EXPECT_EQ(geometry.getNodeSets().at(set).nodes.size(), 2 * counts[set - 1] - 1);
+        EXPECT_EQ(geometry.getBoundaries()[set - 1].nodes.size(), 2 * counts[set - 1] - 1);
+    }
+}
@@ -114,6 +114,38 @@ TEST(LinearElement, StiffnessMatrix)
         EXPECT_DOUBLE_EQ(result[i].value(), 0);
 }
 
+TEST(LinearElement, UpperStiffnessMatrix)
+{
+    Node node_1(0.0, 0.0, 2);
+    Node node_2(0.0, 1.0, 0);
+    Node node_3(1.0, 0.0, 1);
+
+    LinearTriangleElement element(node_1, node_2, node_3);
+
+    Eigen::Matrix3d D;
+    D << 1.0, 0.3, 0.0,
+         0.3, 1.0, 0.0,
+         0.0, 0.0, 0.35;
+
+    Eigen::Matrix<double, 6, 6> full = Eigen::Matrix<double, 6, 6>::Zero();
+    for (auto &triplet: element.calculateStiffnessMatrix(D))
+        full(triplet.row(), triplet.col()) += triplet.value();
+
+    auto result = element.calculateUpperStiffnessMatrix(D);
+    EXPECT_EQ(result.size(), 21);
+
+    Eigen::Matrix<double, 6, 6> upper = Eigen::Matrix<double, 6, 6>::Zero();
+    for (auto &triplet: result)
+    {
+        EXPECT_LE(triplet.row(), triplet.col());
+        upper(triplet.row(), triplet.col()) += triplet.value();
+    }
+
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            EXPECT_DOUBLE_EQ(upper(i, j), i <= j ? full(i, j) : 0.0);
+}
+
 TEST(LinearElement, Stress)
 {
     Node node_1(0.0, 0.0, 0);
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include <Eigen/Eigenvalues>
+
+#include "modalSolver.hpp"
+#include "solver.hpp"
+
+
+/// @brief Lowest eigenvalues of the dense problem restricted to DOFs with mass
+static Eigen::VectorX<double> denseEigenvalues(Solver &solver, const SparseMatrix &M)
+{
+    std::vector<int> free;
+    for (int i = 0; i < M.rows(); ++i)
+        if (M.coeff(i, i) > 0.0)
+            free.push_back(i);
+
+    const Eigen::MatrixX<double> K = SparseMatrix(solver.getMatrix().selfadjointView<Eigen::Upper>());
+    const Eigen::MatrixX<double> denseM = M;
+    Eigen::MatrixX<double> Kf(free.size(), free.size()), Mf(free.size(), free.size());
+    for (int i = 0; i < free.size(); ++i)
+        for (int j = 0; j < free.size(); ++j)
+        {
+            Kf(i, j) = K(free[i], free[j]);
+            Mf(i, j) = denseM(free[i], free[j]);
+        }
+
+    Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixX<double>> eigen(Kf, Mf);
+    return eigen.eigenvalues();
+}
+
+TEST(ModalSolver, MassMatrix)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyConstraints();
+
+    ModalSolver consistent(solver, 7850.0, ModalSolver::CONSISTENT);
+    ModalSolver lumped(solver, 7850.0, ModalSolver::LUMPED);
+
+    // Row sums of the consistent matrix are the lumped masses of unconstrained DOFs
+    const SparseMatrix &M = consistent.getMassMatrix();
+    const Eigen::VectorX<double> ones = Eigen::VectorX<double>::Ones(M.rows());
+    const Eigen::VectorX<double> sums = M * ones;
+    const Eigen::VectorX<double> diagonal = lumped.getMassMatrix().diagonal();
+    for (int i = 0; i < M.rows(); ++i)
+        if (diagonal(i) > 0.0 && M.coeff(i, i) > 0.0)
+        {
+            // Rows of DOFs next to constraints lose constrained neighbours
+            EXPECT_LE(sums(i), diagonal(i) * (1.0 + 1.e-12));
+        }
+
+    double area = 0.0;
+    for (auto element: solver.getGeometry().getElements())
+        area += element->getSquare();
+    EXPECT_LE(diagonal.sum(), 2.0 * 7850.0 * area * (1.0 + 1.e-12));
+    EXPECT_GT(diagonal.sum(), 0.0);
+
+    for (int index: solver.getConstrainedDofs())
+        EXPECT_EQ(M.coeff(index, index), 0.0);
+}
+
+TEST(ModalSolver, MatchesDenseEigenvalues)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyConstraints();
+
+    for (auto type: {ModalSolver::CONSISTENT, ModalSolver::LUMPED})
+    {
+        ModalSolver modal(solver, 7850.0, type);
+        modal.setBlockSize(3);
+        modal.solve(6);
+
+        const Eigen::VectorX<double> expected = denseEigenvalues(solver, modal.getMassMatrix());
+        const SparseMatrix &M = modal.getMassMatrix();
+        const Eigen::MatrixX<double> &modes = modal.getModes();
+        ASSERT_EQ(modal.getEigenvalues().size(), 6);
+        for (int i = 0; i < 6; ++i)
+        {
+            EXPECT_NEAR(modal.getEigenvalues()(i), expected(i), 1.e-8 * expected(i));
+
+            // K * x = lambda * M * x and mass normalization
+            const Eigen::VectorX<double> x = modes.col(i);
+            const Eigen::VectorX<double> residual = solver.getMatrix().selfadjointView<Eigen::Upper>() * x - modal.getEigenvalues()(i) * (M * x);
+            EXPECT_LT(residual.norm(), 1.e-6 * modal.getEigenvalues()(i) * (M * x).norm());
+            EXPECT_NEAR(x.dot(M * x), 1.0, 1.e-10);
+            for (int index: solver.getConstrainedDofs())
+                EXPECT_NEAR(x(index), 0.0, 1.e-12);
+        }
+        EXPECT_NEAR(modal.getFrequencies()(0), std::sqrt(expected(0)) / (2.0 * M_PI), 1.e-8 * std::sqrt(expected(0)));
+    }
+}
+
+TEST(ModalSolver, Shift)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.refine(std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    solver.calcuateStiffnessMatrix();
+    solver.applyConstraints();
+
+    ModalSolver modal(solver, 7850.0);
+    const Eigen::VectorX<double> expected = denseEigenvalues(solver, modal.getMassMatrix());
+
+    // Modes closest to the shift in the middle of the spectrum
+    const double shift = 0.5 * (expected(10) + expected(11));
+    modal.solve(2, shift);
+    EXPECT_NEAR(modal.getEigenvalues()(0), expected(10), 1.e-8 * expected(10));
+    EXPECT_NEAR(modal.getEigenvalues()(1), expected(11), 1.e-8 * expected(11));
+
+    modal.saveMode("mode_test.txt", 1);
+    std::ifstream input("mode_test.txt");
+    int lines = 0;
+    std::string line;
+    while (std::getline(input, line))
+        ++lines;
+    input.close();
+    std::remove("mode_test.txt");
+    EXPECT_EQ(lines, solver.getGeometry().getNodes().size());
+
+    EXPECT_THROW(modal.saveMode("mode_test.txt", 2), const char*);
+    EXPECT_THROW(modal.solve(0), const char*);
+}
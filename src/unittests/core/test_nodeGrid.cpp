@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include "nodeGrid.hpp"
+
+
+static std::vector<Node> randomNodes(int count)
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> x(0.0, 2.0), y(-1.0, 0.5);
+    std::vector<Node> nodes;
+    for (int i = 0; i < count; ++i)
+        nodes.push_back(Node(x(generator), y(generator), i));
+    return nodes;
+}
+
+TEST(NodeGrid, Box)
+{
+    auto nodes = randomNodes(5000);
+    NodeGrid grid;
+    grid.build(nodes);
+
+    const double boxes[3][4] = {{0.3, 0.9, -0.2, 0.1}, {-5.0, 5.0, -5.0, 5.0}, {1.5, 1.0, 0.0, 0.1}};
+    for (auto &box: boxes)
+    {
+        std::vector<Index> expected;
+        for (int i = 0; i < nodes.size(); ++i)
+            if (nodes[i].x >= box[0] && nodes[i].x <= box[1] && nodes[i].y >= box[2] && nodes[i].y <= box[3])
+                expected.push_back(i);
+
+        EXPECT_EQ(grid.findInBox(box[0], box[1], box[2], box[3]), expected);
+    }
+}
+
+TEST(NodeGrid, Segment)
+{
+    auto nodes = randomNodes(5000);
+    NodeGrid grid;
+    grid.build(nodes);
+
+    const double segments[4][5] = {{0.0, -1.0, 2.0, 0.5, 0.01}, {0.5, 0.0, 0.5, 0.0, 0.1},
+                                   {-1.0, 0.2, 3.0, 0.2, 0.02}, {1.9, 0.4, 0.1, -0.9, 0.3}};
+    for (auto &s: segments)
+    {
+        const double dx = s[2] - s[0], dy = s[3] - s[1];
+        std::vector<Index> expected;
+        for (int i = 0; i < nodes.size(); ++i)
+        {
+            double t = dx * dx + dy * dy > 0.0 ? ((nodes[i].x - s[0]) * dx + (nodes[i].y - s[1]) * dy) / (dx * dx + dy * dy) : 0.0;
+            t = std::max(0.0, std::min(1.0, t));
+            if (std::hypot(nodes[i].x - s[0] - t * dx, nodes[i].y - s[1] - t * dy) <= s[4])
+                expected.push_back(i);
+        }
+
+        EXPECT_FALSE(expected.empty());
+        EXPECT_EQ(grid.findNearSegment(s[0], s[1], s[2], s[3], s[4]), expected);
+    }
+}
+
+TEST(NodeGrid, Degenerate)
+{
+    // All nodes on a line, the grid must not collapse
+    std::vector<Node> nodes;
+    for (int i = 0; i < 100; ++i)
+        nodes.push_back(Node(0.0, 0.01 * i, i));
+    NodeGrid grid;
+    grid.build(nodes);
+
+    EXPECT_EQ(grid.findInBox(-1.0, 1.0, 0.095, 0.205).size(), 11);
+    EXPECT_EQ(grid.findNearSegment(0.0, 0.0, 0.0, 1.0, 1.e-10).size(), 100);
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+
+#include "server.hpp"
+
+
+static std::vector<std::string> serve(const std::string &requests)
+{
+    Server server(0.3, 2.e11, Solver::LDLT);
+    std::istringstream input(requests);
+    std::ostringstream output;
+    server.run(input, output);
+
+    std::vector<std::string> lines;
+    std::istringstream responses(output.str());
+    std::string line;
+    while (std::getline(responses, line))
+        lines.push_back(line);
+    return lines;
+}
+
+class TestServer : public Server
+{
+public:
+    TestServer() : Server(0.3, 2.e11, Solver::LDLT) {}
+
+    using Server::getSolver;
+};
+
+TEST(Server, Requests)
+{
+    auto lines = serve("SOLVE\n"
+                       "LOAD data/mesh_coarse.k\n"
+                       "SOLVE\n"
+                       "PROBE 2\n0.15 0.25\n1 1\n"
+                       "UNKNOWN\n"
+                       "QUIT\n"
+                       "SOLVE\n");
+
+    ASSERT_EQ(lines.size(), 8);
+    EXPECT_EQ(lines[0], "ERROR Mesh is not loaded");
+    EXPECT_EQ(lines[1].substr(0, 9), "OK 28 38 ");
+    EXPECT_EQ(lines[2].substr(0, 3), "OK ");
+    EXPECT_EQ(lines[3], "OK 2");
+    EXPECT_NE(lines[4].substr(0, 2), "-1");
+    EXPECT_EQ(lines[5].substr(0, 2), "-1");
+    EXPECT_EQ(lines[6], "ERROR Unknown request");
+    EXPECT_EQ(lines[7], "OK");
+}
+
+TEST(Server, MaterialAndLoadCases)
+{
+    Solver reference("data/mesh_coarse.k", 0.3, 4.e11);
+    reference.calcuateStiffnessMatrix();
+    reference.applyLoad();
+    reference.solve();
+    const Eigen::VectorX<double> u = reference.getDisplacements();
+
+    // Young modulus change reuses the factorization, doubled load gives doubled displacements
+    auto lines = serve("LOAD data/mesh_coarse.k\n"
+                       "MATERIAL 0.3 4e11\n"
+                       "SOLVE\n"
+                       "PROBE 1\n0.15 0.25\n"
+                       "MATERIAL 0.25 4e11\n"
+                       "MATERIAL 0.3 4e11\n"
+                       "SOLVE\n"
+                       "PROBE 1\n0.15 0.25\n");
+    ASSERT_EQ(lines.size(), 10);
+
+    const int node = reference.getGeometry().getNode(3).id;
+    int element;
+    double ux, uy;
+    std::istringstream(lines[4]) >> element >> ux >> uy;
+    EXPECT_NEAR(ux, u(2 * node), 1.e-9 * std::abs(u(2 * node)));
+    EXPECT_NEAR(uy, u(2 * node + 1), 1.e-9 * std::abs(u(2 * node + 1)));
+    std::istringstream(lines[9]) >> element >> ux >> uy;
+    EXPECT_NEAR(ux, u(2 * node), 1.e-9 * std::abs(u(2 * node)));
+
+    // Nodal load case: a single force at the corner
+    lines = serve("LOAD data/mesh_coarse.k\n"
+                  "LOADCASE 1\n3 1 1000.0\n"
+                  "SOLVE\n"
+                  "LOADCASE 1\n3 1 2000.0\n"
+                  "SOLVE\n"
+                  "LOADCASE DEFAULT\n"
+                  "SOLVE\n");
+    ASSERT_EQ(lines.size(), 7);
+    double first, second, last;
+    std::string ok;
+    std::istringstream(lines[2]) >> ok >> ux >> first;
+    std::istringstream(lines[4]) >> ok >> ux >> second;
+    std::istringstream(lines[6]) >> ok >> ux >> last;
+    EXPECT_NEAR(second, 2.0 * first, 1.e-9 * second);
+    EXPECT_NEAR(last, u.cwiseAbs().maxCoeff() * 2.0, 1.e-9 * last);
+
+    // Backend selected after LOAD is applied by MATERIAL
+    TestServer server;
+    std::istringstream input;
+    std::ostringstream output;
+    server.handle("LOAD data/mesh_coarse.k", input, output);
+    server.handle("BACKEND supernodal", input, output);
+    EXPECT_EQ(server.getSolver().getBackend(), Solver::LDLT);
+    server.handle("MATERIAL 0.3 4e11", input, output);
+    EXPECT_EQ(server.getSolver().getBackend(), Solver::SUPERNODAL);
+    server.getSolver().solve();
+    const Eigen::VectorX<double> &v = server.getSolver().getDisplacements();
+    EXPECT_LE((v - u).norm(), 1.e-9 * u.norm());
+}
+
+TEST(Server, Checkpoint)
+{
+    // The first server saves the factorization, the next one loads it
+    std::string filename;
+    for (bool isLoaded: {false, true})
+    {
+        TestServer server;
+        server.setCheckpointDirectory(".");
+        std::istringstream input;
+        std::ostringstream output;
+        server.handle("BACKEND supernodal", input, output);
+        if (!isLoaded)
+        {
+            Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+            solver.setCheckpointDirectory(".");
+            solver.calcuateStiffnessMatrix();
+            solver.applyLoad();
+            filename = solver.getCheckpointFilename();
+            std::remove(filename.c_str());
+        }
+        server.handle("LOAD data/mesh_coarse.k", input, output);
+        EXPECT_EQ(server.getSolver().isCheckpointLoaded(), isLoaded);
+    }
+    std::remove(filename.c_str());
+}
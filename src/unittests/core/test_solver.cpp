@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
 #include "solver.hpp"
 
 
@@ -86,6 +91,38 @@ TEST(Solver, CheckMatrixAfterLoad)
     //         EXPECT_DOUBLE_EQ(matrix(i, j), i == j ? 1.0 : 0.0);
 }
 
+TEST(Solver, UpperStorage)
+{
+    Solver solver("data/mesh_coarse.k");
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    const SparseMatrix &K = solver.getMatrix();
+    for (int k = 0; k < K.outerSize(); ++k)
+        for (SparseMatrix::InnerIterator it(K, k); it; ++it)
+            EXPECT_LE(it.row(), k);
+
+    // Full matrix assembled from the elements, rows and columns of constraints are identity
+    std::vector<Triplet> triplets;
+    for (auto element: solver.getGeometry().getElements())
+    {
+        auto local = element->calculateStiffnessMatrix(solver.getElasticityMatrix());
+        triplets.insert(triplets.end(), local.begin(), local.end());
+    }
+    SparseMatrix full(K.rows(), K.cols());
+    full.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::MatrixX<double> expected(full);
+    for (int index: solver.getConstrainedDofs())
+    {
+        expected.row(index).setZero();
+        expected.col(index).setZero();
+        expected(index, index) = 1.0;
+    }
+
+    const Eigen::MatrixX<double> actual = SparseMatrix(K.selfadjointView<Eigen::Upper>());
+    EXPECT_LT((actual - expected).norm(), 1.e-12 * expected.norm());
+}
+
 TEST(Solver, Solve)
 {
     Solver solver("data/mesh_simple.k");
@@ -101,6 +138,23 @@ TEST(Solver, Solve)
     EXPECT_DOUBLE_EQ(result(4), 0.0);
 }
 
+TEST(Solver, StressMatrix)
+{
+    Solver solver("data/mesh_coarse.k");
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    solver.solve();
+
+    auto expected = solver.calculateStress();
+    Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor> stress;
+    solver.calculateStress(stress);
+
+    ASSERT_EQ(stress.rows(), expected.size());
+    for (int i = 0; i < expected.size(); ++i)
+        for (int j = 0; j < 4; ++j)
+            EXPECT_EQ(stress(i, j), expected[i][j]);
+}
+
 TEST(SolverCoarse, CheckFAfterLoad)
 {
     Solver solver("data/mesh_coarse.k");
@@ -115,3 +169,183 @@ TEST(SolverCoarse, CheckFAfterLoad)
     EXPECT_DOUBLE_EQ(vector(22), 63453.00000000001);
     EXPECT_DOUBLE_EQ(vector(4), 31726.500000000005);
 }
+
+TEST(SolverKeywords, MatchesDefaults)
+{
+    Solver defaults("data/mesh_coarse.k");
+    defaults.calcuateStiffnessMatrix();
+    defaults.applyLoad();
+
+    Solver solver("data/mesh_coarse_keywords.k");
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    EXPECT_LT((solver.getLoadVector() - defaults.getLoadVector()).norm(), 1.e-9 * defaults.getLoadVector().norm());
+    EXPECT_LT((solver.getMatrix() - defaults.getMatrix()).norm(), 1.e-12 * defaults.getMatrix().norm());
+
+    // Loads are not accumulated by repeated calls
+    solver.applyLoad();
+    EXPECT_LT((solver.getLoadVector() - defaults.getLoadVector()).norm(), 1.e-9 * defaults.getLoadVector().norm());
+}
+
+TEST(SolverKeywords, NodalLoad)
+{
+    std::ofstream output("mesh_nodal_load.k");
+    output << "*NODE\n1 0 0\n2 1 0\n3 1 1\n4 0 1\n"
+           << "*ELEMENT_SHELL\n1 1 1 2 3 3\n2 1 1 3 4 4\n"
+           << "*SET_NODE_SEGMENT\n1 0 0 1 0 1e-9\n"
+           << "*BOUNDARY_SPC_SET\n1 0 1 1\n"
+           << "*LOAD_NODE\n3 2 5.0\n4 1 -2.0\n"
+           << "*END\n";
+    output.close();
+
+    Solver solver("mesh_nodal_load.k");
+    std::remove("mesh_nodal_load.k");
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    Eigen::VectorX<double> expected(8);
+    expected << 0.0, 0.0, 0.0, 0.0, 0.0, 5.0, -2.0, 0.0;
+    EXPECT_EQ(solver.getLoadVector(), expected);
+
+    Eigen::MatrixX<double> matrix(solver.getMatrix());
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 8; ++j)
+            EXPECT_DOUBLE_EQ(matrix(i, j), i == j ? 1.0 : 0.0);
+}
+
+TEST(SolverProbe, Interpolation)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    solver.solve();
+
+    auto &elements = solver.getGeometry().getElements();
+    auto stress = solver.calculateStress();
+    const auto &u = solver.getDisplacements();
+
+    // Nodes of an element and its centroid
+    std::vector<Eigen::Vector2d> points;
+    for (int i = 0; i < elements.size(); ++i)
+    {
+        Eigen::Vector2d centroid(0.0, 0.0);
+        for (int j = 0; j < 3; ++j)
+            centroid += Eigen::Vector2d(elements[i]->getNode(j).x, elements[i]->getNode(j).y) / 3.0;
+        points.push_back(centroid);
+    }
+    points.push_back(Eigen::Vector2d(0.15, 0.25));
+    points.push_back(Eigen::Vector2d(1.0, 1.0));
+
+    auto probes = solver.probe(points);
+    ASSERT_EQ(probes.size(), points.size());
+    for (int i = 0; i < elements.size(); ++i)
+    {
+        EXPECT_EQ(probes[i].element, i);
+        double ux = 0.0, uy = 0.0;
+        for (int j = 0; j < 3; ++j)
+        {
+            ux += u(2 * elements[i]->getNode(j).id + 0) / 3.0;
+            uy += u(2 * elements[i]->getNode(j).id + 1) / 3.0;
+        }
+        EXPECT_NEAR(probes[i].ux, ux, 1.e-12 * u.norm());
+        EXPECT_NEAR(probes[i].uy, uy, 1.e-12 * u.norm());
+        EXPECT_DOUBLE_EQ(probes[i].sx, stress[i][0]);
+        EXPECT_DOUBLE_EQ(probes[i].s, stress[i][3]);
+    }
+
+    const auto &corner = probes[elements.size()];
+    const int node = solver.getGeometry().getNode(3).id;
+    EXPECT_NE(corner.element, -1);
+    EXPECT_NEAR(corner.ux, u(2 * node), 1.e-12 * u.norm());
+
+    EXPECT_EQ(probes.back().element, -1);
+    EXPECT_TRUE(std::isnan(probes.back().ux));
+}
+
+/// Releases the first constrained node and fixes two free ones
+static void changeConstraints(Solver &solver)
+{
+    auto &boundaries = solver.getGeometry().getBoundaries();
+    for (auto &boundary : boundaries)
+    {
+        auto it = std::find_if(boundary.nodes.begin(), boundary.nodes.end(),
+                               [](const BoundaryNode &node) { return node.type != BoundaryNode::F; });
+        if (it != boundary.nodes.end())
+        {
+            boundary.nodes.erase(it);
+            break;
+        }
+    }
+
+    const int nodesCount = solver.getGeometry().getNodes().size();
+    Boundary fixed;
+    fixed.nodes.push_back(BoundaryNode(BoundaryNode::UXY, nodesCount / 2));
+    fixed.nodes.push_back(BoundaryNode(BoundaryNode::UY, nodesCount / 3));
+    boundaries.push_back(fixed);
+}
+
+TEST(SolverConstraints, LowRankUpdate)
+{
+    for (auto backend : {Solver::LDLT, Solver::SUPERNODAL, Solver::DOMAIN_DECOMPOSITION})
+    {
+        Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+        solver.setBackend(backend);
+        solver.calcuateStiffnessMatrix();
+        solver.applyLoad();
+        solver.solve();
+        const Eigen::VectorX<double> original = solver.getDisplacements();
+
+        // Reference is assembled and factorized with the changed constraints
+        Solver reference("data/mesh_coarse.k", 0.3, 2.e11);
+        changeConstraints(reference);
+        reference.calcuateStiffnessMatrix();
+        reference.applyLoad();
+        reference.solve();
+
+        changeConstraints(solver);
+        solver.applyLoad();
+        // One released DOF and two fixed ones, the other DOF of the middle node is fixed already
+        EXPECT_EQ(solver.getUpdateRank(), 2 * 3);
+        EXPECT_LT((solver.getMatrix() - reference.getMatrix()).norm(), 1.e-12 * reference.getMatrix().norm());
+
+        solver.solve();
+        const Eigen::VectorX<double> &expected = reference.getDisplacements();
+        EXPECT_LT((solver.getDisplacements() - expected).norm(), 1.e-9 * expected.norm());
+
+        // Back to the factorized constraints
+        Solver restored("data/mesh_coarse.k", 0.3, 2.e11);
+        solver.getGeometry().getBoundaries() = restored.getGeometry().getBoundaries();
+        solver.applyLoad();
+        EXPECT_EQ(solver.getUpdateRank(), 0);
+        solver.solve();
+        EXPECT_LT((solver.getDisplacements() - original).norm(), 1.e-12 * original.norm());
+    }
+}
+
+TEST(SolverConstraints, ManyChangesRefactorize)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    solver.solve();
+
+    // Fixing all nodes is not a low-rank change
+    Boundary fixed;
+    for (int i = 0; i < solver.getGeometry().getNodes().size(); ++i)
+        fixed.nodes.push_back(BoundaryNode(BoundaryNode::UXY, i));
+    solver.getGeometry().getBoundaries().push_back(fixed);
+    solver.applyLoad();
+    EXPECT_EQ(solver.getUpdateRank(), 0);
+
+    solver.solve();
+    EXPECT_EQ(solver.getDisplacements().norm(), 0.0);
+
+    // Releasing them restores the stiffness of the original constraints
+    solver.getGeometry().getBoundaries().pop_back();
+    solver.applyLoad();
+    Solver reference("data/mesh_coarse.k", 0.3, 2.e11);
+    reference.calcuateStiffnessMatrix();
+    reference.applyLoad();
+    EXPECT_LT((solver.getMatrix() - reference.getMatrix()).norm(), 1.e-12 * reference.getMatrix().norm());
+}
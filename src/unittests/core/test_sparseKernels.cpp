@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "parallel.hpp"
+#include "solver.hpp"
+#include "sparseKernels.hpp"
+
+
+TEST(SparseKernels, MultiplySymmetric)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    const RowMajorMatrix upper = solver.getMatrix();
+    const RowMajorMatrix full = SparseMatrix(solver.getMatrix().selfadjointView<Eigen::Upper>());
+    const Eigen::VectorX<double> x = Eigen::VectorX<double>::Random(upper.rows());
+    const Eigen::VectorX<double> b = Eigen::VectorX<double>::Random(upper.rows());
+
+    Eigen::VectorX<double> expected, expectedResidual;
+    multiply(full, x, expected);
+    residual(full, x, b, expectedResidual);
+
+    // Serial path and several chunks with private scatter buffers
+    const int threadsCount = getThreadsCount();
+    for (int threads: {1, 3, 8})
+    {
+        setThreadsCount(threads);
+
+        Eigen::VectorX<double> y, r;
+        multiplySymmetric(upper, x, y);
+        residualSymmetric(upper, x, b, r);
+
+        EXPECT_LT((y - expected).norm(), 1.e-12 * expected.norm());
+        EXPECT_LT((r - expectedResidual).norm(), 1.e-12 * expected.norm());
+
+        // Buffers of a prepared product are reused, concurrent products take their own
+        SymmetricProduct product;
+        product.compute(upper);
+        for (int repeat = 0; repeat < 2; ++repeat)
+        {
+            product.multiply(x, y);
+            product.residual(x, b, r);
+            EXPECT_LT((y - expected).norm(), 1.e-12 * expected.norm());
+            EXPECT_LT((r - expectedResidual).norm(), 1.e-12 * expected.norm());
+        }
+        std::vector<Eigen::VectorX<double>> products(4);
+        parallelFor(0, products.size(), [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+                product.multiply(x, products[i]);
+        });
+        for (auto &z: products)
+            EXPECT_LT((z - expected).norm(), 1.e-12 * expected.norm());
+    }
+    setThreadsCount(threadsCount);
+}
+
+TEST(SparseKernels, SymmetricProductBuffers)
+{
+    // Chunks of a tridiagonal matrix scatter to their own rows and the first row of the next chunk
+    const int n = 1000;
+    std::vector<Triplet> triplets;
+    for (int i = 0; i < n; ++i)
+    {
+        triplets.emplace_back(i, i, 2.0);
+        if (i < n - 1)
+            triplets.emplace_back(i, i + 1, -1.0);
+    }
+    SparseMatrix matrix(n, n);
+    matrix.setFromTriplets(triplets.begin(), triplets.end());
+    const RowMajorMatrix upper = matrix;
+    const RowMajorMatrix full = SparseMatrix(matrix.selfadjointView<Eigen::Upper>());
+    const Eigen::VectorX<double> x = Eigen::VectorX<double>::Random(n);
+
+    const int threadsCount = getThreadsCount();
+    setThreadsCount(4);
+    SymmetricProduct product;
+    product.compute(upper);
+    setThreadsCount(threadsCount);
+    EXPECT_EQ(product.getBufferSize(), n + 3);
+
+    Eigen::VectorX<double> y, expected;
+    product.multiply(x, y);
+    multiply(full, x, expected);
+    EXPECT_LT((y - expected).norm(), 1.e-12 * expected.norm());
+}
@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "parallel.hpp"
+#include "solver.hpp"
+#include "supernodalCholesky.hpp"
+#include "threadPool.hpp"
+
+
+TEST(SupernodalCholesky, NestedDissectionIsPermutation)
+{
+    // 20 x 20 grid graph
+    const int side = 20;
+    std::vector<Index> adjPtr(1, 0), adj;
+    for (int j = 0; j < side; ++j)
+        for (int i = 0; i < side; ++i)
+        {
+            if (i > 0) adj.push_back(j * side + i - 1);
+            if (i < side - 1) adj.push_back(j * side + i + 1);
+            if (j > 0) adj.push_back((j - 1) * side + i);
+            if (j < side - 1) adj.push_back((j + 1) * side + i);
+            adjPtr.push_back(adj.size());
+        }
+
+    auto order = SupernodalCholesky::nestedDissection(adjPtr, adj);
+
+    ASSERT_EQ(order.size(), side * side);
+    std::sort(order.begin(), order.end());
+    for (int i = 0; i < side * side; ++i)
+        EXPECT_EQ(order[i], i);
+}
+
+TEST(SupernodalCholesky, SolveDenseSystem)
+{
+    Eigen::MatrixX<double> A = Eigen::MatrixX<double>::Random(30, 30);
+    A = A * A.transpose() + 30.0 * Eigen::MatrixX<double>::Identity(30, 30);
+    SparseMatrix K = A.sparseView();
+    Eigen::VectorX<double> b = Eigen::VectorX<double>::Random(30);
+
+    SupernodalCholesky cholesky;
+    cholesky.compute(K);
+
+    Eigen::VectorX<double> x = cholesky.solve(b);
+    EXPECT_LT((A * x - b).norm(), 1.e-10 * b.norm());
+}
+
+TEST(SupernodalCholesky, NotPositiveDefinite)
+{
+    SparseMatrix K(2, 2);
+    K.insert(0, 0) = 1.0;
+    K.insert(1, 1) = -1.0;
+
+    SupernodalCholesky cholesky;
+    cholesky.analyzePattern(K);
+    EXPECT_ANY_THROW(cholesky.factorize(K));
+}
+
+TEST(SupernodalCholesky, MatchesLDLT)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    solver.solve();
+    Eigen::VectorX<double> expected = solver.getDisplacements();
+
+    for (int threads: {1, 4})
+    {
+        setThreadsCount(threads);
+        solver.setBackend(Solver::SUPERNODAL);
+        solver.solve();
+
+        EXPECT_LT((solver.getDisplacements() - expected).norm(), 1.e-10 * expected.norm());
+    }
+}
+
+TEST(SupernodalCholesky, FactorizeInPoolJobs)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    SupernodalCholesky reference;
+    reference.compute(solver.getMatrix());
+    const Eigen::VectorX<double> expected = reference.solve(solver.getLoadVector());
+    const SparseMatrix negative = -solver.getMatrix();
+
+    // Supernodes of concurrent jobs are scheduled on the pool, a failed job waits for its helpers
+    std::vector<double> errors(6, -1.0);
+    std::atomic<int> failures(0);
+    {
+        ThreadPool pool(3);
+        for (int job = 0; job < errors.size(); ++job)
+        {
+            pool.submit([&, job]
+            {
+                setLocalThreadsCount(4);
+                SupernodalCholesky cholesky;
+                try
+                {
+                    cholesky.compute(job % 3 == 2 ? negative : solver.getMatrix());
+                    errors[job] = (cholesky.solve(solver.getLoadVector()) - expected).norm();
+                }
+                catch (const char *)
+                {
+                    ++failures;
+                }
+                setLocalThreadsCount(0);
+            });
+        }
+        pool.wait();
+    }
+
+    EXPECT_EQ(failures, 2);
+    for (int job = 0; job < errors.size(); ++job)
+    {
+        if (job % 3 != 2)
+        {
+            EXPECT_LT(errors[job], 1.e-12 * expected.norm());
+        }
+    }
+
+    // Workers take supernodes of a single job, the upper levels of the tree too
+    const int side = 150;
+    std::vector<Triplet> triplets;
+    for (int j = 0; j < side; ++j)
+        for (int i = 0; i < side; ++i)
+        {
+            const int k = j * side + i;
+            triplets.emplace_back(k, k, 4.0);
+            if (i < side - 1) triplets.emplace_back(k, k + 1, -1.0);
+            if (j < side - 1) triplets.emplace_back(k, k + side, -1.0);
+        }
+    SparseMatrix laplacian(side * side, side * side);
+    laplacian.setFromTriplets(triplets.begin(), triplets.end());
+    const Eigen::VectorX<double> b = Eigen::VectorX<double>::Ones(side * side);
+
+    SupernodalCholesky cholesky;
+    Eigen::VectorX<double> x;
+    {
+        ThreadPool pool(4);
+        pool.submit([&]
+        {
+            setLocalThreadsCount(4);
+            cholesky.compute(laplacian);
+            x = cholesky.solve(b);
+            setLocalThreadsCount(0);
+        });
+        pool.wait();
+    }
+    EXPECT_GT(cholesky.getWorkersCount(), 1);
+    EXPECT_LT((laplacian.selfadjointView<Eigen::Upper>() * x - b).norm(), 1.e-10 * b.norm());
+}
+
+TEST(SupernodalCholesky, Checkpoint)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    SupernodalCholesky cholesky;
+    cholesky.compute(solver.getMatrix());
+    const Eigen::VectorX<double> expected = cholesky.solve(solver.getLoadVector());
+    cholesky.save("test_checkpoint.chol", 42);
+
+    SupernodalCholesky loaded;
+    EXPECT_FALSE(loaded.load("test_checkpoint.chol", 43));
+    EXPECT_FALSE(loaded.load("missing_checkpoint.chol", 42));
+    ASSERT_TRUE(loaded.load("test_checkpoint.chol", 42));
+    EXPECT_EQ(loaded.getPermutation(), cholesky.getPermutation());
+    EXPECT_EQ(loaded.getSupernodesCount(), cholesky.getSupernodesCount());
+    EXPECT_EQ(loaded.getFactorSize(), cholesky.getFactorSize());
+    EXPECT_EQ((loaded.solve(solver.getLoadVector()) - expected).norm(), 0.0);
+
+    // Restored pattern is enough for a new numeric factorization
+    SparseMatrix K = 2.0 * solver.getMatrix();
+    loaded.factorize(K);
+    EXPECT_LT((2.0 * loaded.solve(solver.getLoadVector()) - expected).norm(), 1.e-12 * expected.norm());
+
+    // Truncated file is rejected
+    {
+        std::ifstream input("test_checkpoint.chol", std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        std::ofstream output("test_checkpoint.chol", std::ios::binary);
+        output.write(content.data(), content.size() - 8);
+    }
+    EXPECT_FALSE(loaded.load("test_checkpoint.chol", 42));
+    std::remove("test_checkpoint.chol");
+}
+
+TEST(SupernodalCholesky, CorruptCheckpoint)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+
+    SupernodalCholesky cholesky;
+    cholesky.compute(solver.getMatrix());
+    const Eigen::VectorX<double> expected = cholesky.solve(solver.getLoadVector());
+    cholesky.save("test_checkpoint.chol", 42);
+
+    std::string content;
+    {
+        std::ifstream input("test_checkpoint.chol", std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    // Header: magic, key, size, supernodes, lower entries, rows, factor size and offset, then perm, lowerPtr,
+    // lowerRows, lowerSource, supernodes of 6 values and rows
+    int64_t header[8];
+    std::memcpy(header, content.data(), sizeof(header));
+    const size_t permOffset = sizeof(header);
+    const size_t lowerPtrOffset = permOffset + sizeof(Index) * header[2];
+    const size_t lowerRowsOffset = lowerPtrOffset + sizeof(Index) * (header[2] + 1);
+    const size_t nodesOffset = lowerRowsOffset + 2 * sizeof(Index) * header[4];
+    const size_t rowsOffset = nodesOffset + 6 * sizeof(int64_t) * header[3];
+
+    // Files of consistent size with wrong contents are misses, the loaded solver is kept
+    SupernodalCholesky loaded;
+    ASSERT_TRUE(loaded.load("test_checkpoint.chol", 42));
+    auto corrupt = [&](size_t offset, auto value)
+    {
+        std::string changed = content;
+        std::memcpy(&changed[offset], &value, sizeof(value));
+        std::ofstream("test_corrupt.chol", std::ios::binary).write(changed.data(), changed.size());
+        return loaded.load("test_corrupt.chol", 42);
+    };
+    EXPECT_FALSE(corrupt(2 * sizeof(int64_t), int64_t(1) << 61));
+    EXPECT_FALSE(corrupt(4 * sizeof(int64_t), int64_t(-1)));
+    EXPECT_FALSE(corrupt(permOffset + sizeof(Index), static_cast<Index>(0)));
+    EXPECT_FALSE(corrupt(permOffset, static_cast<Index>(header[2])));
+    EXPECT_FALSE(corrupt(lowerPtrOffset + sizeof(Index), static_cast<Index>(header[4] + 1)));
+    EXPECT_FALSE(corrupt(lowerRowsOffset, static_cast<Index>(header[2])));
+    EXPECT_FALSE(corrupt(nodesOffset + 2 * sizeof(int64_t), int64_t(header[3])));
+    EXPECT_FALSE(corrupt(nodesOffset + 1 * sizeof(int64_t), int64_t(0)));
+    EXPECT_FALSE(corrupt(nodesOffset + 5 * sizeof(int64_t), int64_t(8)));
+    EXPECT_FALSE(corrupt(rowsOffset, static_cast<Index>(-1)));
+    EXPECT_TRUE(corrupt(0, content[0]));
+    EXPECT_EQ((loaded.solve(solver.getLoadVector()) - expected).norm(), 0.0);
+    std::remove("test_checkpoint.chol");
+    std::remove("test_corrupt.chol");
+}
+
+TEST(SupernodalCholesky, SolverCheckpoint)
+{
+    Solver solver("data/mesh_coarse.k", 0.3, 2.e11);
+    solver.setBackend(Solver::SUPERNODAL);
+    solver.setCheckpointDirectory(".");
+    solver.calcuateStiffnessMatrix();
+    solver.applyLoad();
+    const std::string filename = solver.getCheckpointFilename();
+    std::remove(filename.c_str());
+
+    solver.solve();
+    EXPECT_FALSE(solver.isCheckpointLoaded());
+    const Eigen::VectorX<double> expected = solver.getDisplacements();
+
+    // The same problem in another run loads the factorization
+    Solver next("data/mesh_coarse.k", 0.3, 2.e11);
+    next.setBackend(Solver::SUPERNODAL);
+    next.setCheckpointDirectory(".");
+    next.calcuateStiffnessMatrix();
+    next.applyLoad();
+    EXPECT_EQ(next.getCheckpointKey(), solver.getCheckpointKey());
+    next.analyzePattern();
+    EXPECT_TRUE(next.isCheckpointLoaded());
+    next.solve();
+    EXPECT_EQ((next.getDisplacements() - expected).norm(), 0.0);
+
+    // Another material is another key
+    Solver other("data/mesh_coarse.k", 0.25, 2.e11);
+    EXPECT_NE(other.getCheckpointKey(), solver.getCheckpointKey());
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parallel.hpp"
+#include "taskGraph.hpp"
+#include "threadPool.hpp"
+
+
+TEST(ThreadPool, RunsAllJobs)
+{
+    std::atomic<int> sum(0);
+    {
+        ThreadPool pool(3);
+        for (int i = 1; i <= 100; ++i)
+            pool.submit([&sum, i] { sum += i; });
+        pool.wait();
+        EXPECT_EQ(sum, 5050);
+        pool.submit([&sum] { sum += 1; });
+    }
+    EXPECT_EQ(sum, 5051);
+}
+
+TEST(ThreadPool, IdleWorkerStealsNestedJob)
+{
+    // The nested job goes to the deque of the busy worker, only the other one can run it
+    std::atomic<bool> isNestedRun(false), isStolen(false);
+    {
+        ThreadPool pool(2);
+        pool.submit([&]
+        {
+            EXPECT_EQ(ThreadPool::getCurrent(), &pool);
+            pool.submit([&isNestedRun] { isNestedRun = true; });
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (!isNestedRun && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+            isStolen = isNestedRun.load();
+        });
+        pool.wait();
+    }
+    EXPECT_TRUE(isStolen);
+    EXPECT_EQ(ThreadPool::getCurrent(), nullptr);
+}
+
+TEST(ThreadPool, ParallelForInJobs)
+{
+    // Concurrent loops share the workers, each one is complete and exceptions reach their caller
+    std::vector<long long> sums(8, 0);
+    std::atomic<int> failures(0);
+    {
+        ThreadPool pool(3);
+        for (int job = 0; job < sums.size(); ++job)
+        {
+            pool.submit([&, job]
+            {
+                setLocalThreadsCount(4);
+                std::mutex mutex;
+                parallelFor(0, 1000, [&](int begin, int end)
+                {
+                    long long sum = 0;
+                    for (int i = begin; i < end; ++i)
+                        sum += i;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    sums[job] += sum;
+                });
+                try
+                {
+                    parallelFor(0, 4, [](int begin, int end) { if (begin <= 2 && 2 < end) throw "Chunk failed"; });
+                }
+                catch (const char *)
+                {
+                    ++failures;
+                }
+                setLocalThreadsCount(0);
+            });
+        }
+        pool.wait();
+    }
+    for (long long sum: sums)
+        EXPECT_EQ(sum, 499500);
+    EXPECT_EQ(failures, sums.size());
+}
+
+TEST(ThreadPool, ParallelForOutsidePool)
+{
+    // Started threads run the chunks, exceptions of any chunk reach the caller after all chunks
+    const int threads = getThreadsCount();
+    setThreadsCount(4);
+    for (int failed = 0; failed < 4; ++failed)
+    {
+        std::atomic<int> done(0);
+        EXPECT_ANY_THROW(parallelFor(0, 4, [&](int begin, int end)
+        {
+            ++done;
+            if (begin <= failed && failed < end)
+                throw "Chunk failed";
+        }));
+        EXPECT_EQ(done, 4);
+    }
+    setThreadsCount(threads);
+}
+
+TEST(TaskGraph, Dependencies)
+{
+    // Diamond a -> (b, c) -> d
+    std::vector<int> finished;
+    std::mutex mutex;
+    auto record = [&](int id) { return [&, id] { std::lock_guard<std::mutex> lock(mutex); finished.push_back(id); }; };
+
+    TaskGraph graph;
+    const int a = graph.add("a", record(0));
+    const int b = graph.add("b", record(1), {a});
+    const int c = graph.add("c", record(2), {a});
+    graph.add("d", record(3), {b, c});
+    EXPECT_ANY_THROW(graph.add("e", record(4), {7}));
+
+    ThreadPool pool(4);
+    graph.run(pool);
+
+    ASSERT_EQ(finished.size(), 4);
+    EXPECT_EQ(finished.front(), 0);
+    EXPECT_EQ(finished.back(), 3);
+    for (auto &task: graph.getTasks())
+        EXPECT_LE(task.start, task.finish);
+    EXPECT_GE(graph.getTasks()[3].start, graph.getTasks()[1].finish);
+    EXPECT_GE(graph.getTasks()[3].start, graph.getTasks()[2].finish);
+}
+
+TEST(TaskGraph, IndependentTasksOverlap)
+{
+    // Each task waits for the other one, so they must run concurrently
+    std::atomic<int> arrived(0);
+    auto meet = [&arrived]
+    {
+        ++arrived;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (arrived < 2 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+        if (arrived < 2)
+            throw "Tasks did not overlap";
+    };
+
+    TaskGraph graph;
+    graph.add("first", meet);
+    graph.add("second", meet);
+
+    ThreadPool pool(2);
+    EXPECT_NO_THROW(graph.run(pool));
+}
+
+TEST(TaskGraph, Failure)
+{
+    std::atomic<bool> isDependentRun(false), isIndependentRun(false);
+
+    TaskGraph graph;
+    const int failing = graph.add("failing", [] { throw "Stage failed"; });
+    const int dependent = graph.add("dependent", [&] { isDependentRun = true; }, {failing});
+    graph.add("transitive", [&] { isDependentRun = true; }, {dependent});
+    graph.add("independent", [&] { isIndependentRun = true; });
+
+    ThreadPool pool(2);
+    try
+    {
+        graph.run(pool);
+        FAIL();
+    }
+    catch (const char *message)
+    {
+        EXPECT_EQ(std::string(message), "Stage failed");
+    }
+    EXPECT_FALSE(isDependentRun);
+    EXPECT_TRUE(isIndependentRun);
+    EXPECT_TRUE(graph.getTasks()[2].isSkipped);
+}
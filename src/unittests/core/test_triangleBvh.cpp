@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "geometry.hpp"
+#include "triangleBvh.hpp"
+
+
+TEST(TriangleBvh, Centroids)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_coarse.k");
+    auto &elements = geometry.getElements();
+
+    TriangleBvh bvh;
+    bvh.build(elements);
+    EXPECT_GT(bvh.getDepth(), 1);
+
+    for (int i = 0; i < elements.size(); ++i)
+    {
+        double x = 0.0, y = 0.0, weights[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            x += elements[i]->getNode(j).x / 3.0;
+            y += elements[i]->getNode(j).y / 3.0;
+        }
+        ASSERT_EQ(bvh.find(x, y, weights), i);
+        for (int j = 0; j < 3; ++j)
+            EXPECT_NEAR(weights[j], 1.0 / 3.0, 1.e-12);
+    }
+
+    double weights[3];
+    EXPECT_EQ(bvh.find(-1.0, 0.1, weights), -1);
+    EXPECT_EQ(bvh.find(0.1, 0.3, weights), -1);
+}
+
+TEST(TriangleBvh, MatchesBruteForce)
+{
+    Geometry geometry;
+    geometry.loadFromFile("data/mesh_coarse.k");
+    for (int i = 0; i < 3; ++i)
+    {
+        std::vector<int> all(geometry.getElements().size());
+        for (int j = 0; j < all.size(); ++j)
+            all[j] = j;
+        geometry.refine(all);
+    }
+    auto &elements = geometry.getElements();
+
+    TriangleBvh bvh;
+    bvh.build(elements);
+
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> x(-0.01, 0.16), y(-0.01, 0.26);
+    int outside = 0;
+    for (int k = 0; k < 10000; ++k)
+    {
+        const double px = x(generator), py = y(generator);
+        double weights[3];
+        const int found = bvh.find(px, py, weights);
+
+        // Random points do not hit common edges, so at most one triangle contains a point
+        int expected = -1;
+        for (int i = 0; i < elements.size() && expected == -1; ++i)
+        {
+            const Node &a = elements[i]->getNode(0), &b = elements[i]->getNode(1), &c = elements[i]->getNode(2);
+            const double d1 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+            const double d2 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+            const double d3 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+            if ((d1 >= 0 && d2 >= 0 && d3 >= 0) || (d1 <= 0 && d2 <= 0 && d3 <= 0))
+                expected = i;
+        }
+        ASSERT_EQ(found, expected);
+        outside += found == -1;
+
+        if (found != -1)
+        {
+            double wx = 0.0, wy = 0.0;
+            for (int j = 0; j < 3; ++j)
+            {
+                wx += weights[j] * elements[found]->getNode(j).x;
+                wy += weights[j] * elements[found]->getNode(j).y;
+            }
+            EXPECT_NEAR(wx, px, 1.e-12);
+            EXPECT_NEAR(wy, py, 1.e-12);
+        }
+    }
+    EXPECT_GT(outside, 0);
+}